@@ -0,0 +1,140 @@
+#include "simd.hpp"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+/**
+  @brief Random square matrix of 64 * \e words sets (one for each character) of
+         \e words 64-bit words (the species of the character), with one bit in
+         8 set, as the characters of a matrix cover a few of its species
+*/
+static std::vector<uint64_t> random_matrix(const size_t words) {
+  std::vector<uint64_t> output(64 * words * words);
+  std::mt19937_64 rng(words);
+
+  for (auto& word : output) word = rng() & rng() & rng();
+
+  return output;
+}
+
+/**
+  @brief Run \e pass until it took at least 100 ms, return the nanoseconds per
+         operation, where each pass makes \e ops operations
+*/
+static double measure(const std::function<size_t()>& pass, const size_t ops) {
+  typedef std::chrono::steady_clock clock;
+
+  size_t passes = 0, sink = 0;
+  const auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+
+  while (elapsed < std::chrono::milliseconds(100)) {
+    sink += pass();
+    passes++;
+    elapsed = clock::now() - start;
+  }
+
+  // keep the results alive
+  if (sink == size_t(-1)) std::printf(" ");
+
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         (passes * ops);
+}
+
+int main(int argc, const char* argv[]) {
+  std::printf("%-8s %-18s %6s %10s %8s\n", "isa", "kernel", "bits", "ns/op",
+              "speedup");
+
+  // 256 to 1024 species and characters
+  for (const size_t words : {4, 8, 16}) {
+    const auto rows = 64 * words;
+    const auto m = random_matrix(words);
+
+    // complement of each row, disjoint from it
+    auto m_not = m;
+    for (auto& word : m_not) word = ~word;
+
+    const std::vector<uint64_t> all(words, ~uint64_t(0));
+    std::vector<uint64_t> out(words);
+
+    const auto row = [&](const std::vector<uint64_t>& matrix, const size_t r) {
+      return &matrix[r * words];
+    };
+
+    // each benchmark makes rows operations per pass: the tests on random rows
+    // stop at the first word, the ones on a row and itself (or its
+    // complement) read every word
+    typedef std::function<size_t(const SetKernels&, size_t)> Operation;
+
+    const std::vector<std::pair<const char*, Operation>> benchmarks{
+        {"is_subset",
+         [&](const SetKernels& k, size_t r) {
+           return k.is_subset(row(m, r), row(m, (r + 1) % rows), words);
+         }},
+        {"is_subset/full",
+         [&](const SetKernels& k, size_t r) {
+           return k.is_subset(row(m, r), row(m, r), words);
+         }},
+        {"intersects/full",
+         [&](const SetKernels& k, size_t r) {
+           return k.intersects(row(m, r), row(m_not, r), words);
+         }},
+        {"equal/full",
+         [&](const SetKernels& k, size_t r) {
+           return k.equal(row(m, r), row(m, r), words);
+         }},
+        {"and",
+         [&](const SetKernels& k, size_t r) {
+           k.and_words(out.data(), row(m, r), row(m, (r + 1) % rows), words);
+           return out[0];
+         }},
+        {"andnot",
+         [&](const SetKernels& k, size_t r) {
+           k.andnot_words(out.data(), row(m, r), row(m, (r + 1) % rows),
+                          words);
+           return out[0];
+         }},
+        {"popcount",
+         [&](const SetKernels& k, size_t r) {
+           return k.popcount(row(m, r), words);
+         }},
+        // scan of the whole matrix for a superset of each row, as in
+        // maximal_characters
+        {"find_row/superset",
+         [&](const SetKernels& k, size_t r) {
+           return k.find_row(SetRelation::superset, m.data(), all.data(),
+                             r + 1, row(m, r), words);
+         }},
+    };
+
+    for (const auto& benchmark : benchmarks) {
+      double scalar_ns = 0;
+
+      for (const auto isa : {SetISA::scalar, SetISA::avx2, SetISA::avx512}) {
+        if (!isa_supported(isa)) continue;
+
+        const auto& kernels = set_kernels(isa);
+        const auto ns = measure(
+            [&]() {
+              size_t output = 0;
+
+              for (size_t r = 0; r < rows; ++r) {
+                output += benchmark.second(kernels, r);
+              }
+
+              return output;
+            },
+            rows);
+
+        if (isa == SetISA::scalar) scalar_ns = ns;
+
+        std::printf("%-8s %-18s %6zu %10.2f %7.2fx\n", to_string(isa).c_str(),
+                    benchmark.first, 64 * words, ns, scalar_ns / ns);
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+#include "functions.hpp"
+#include "generator.hpp"
+#include <boost/graph/connected_components.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+/**
+  @brief Run \e setup and then \e op until the calls of \e op took at least
+         100 ms (only \e op is timed), return the nanoseconds per call and the
+         number of calls
+*/
+static std::pair<double, size_t> measure(const std::function<void()>& setup,
+                                         const std::function<void()>& op) {
+  typedef std::chrono::steady_clock clock;
+
+  size_t calls = 0;
+  auto elapsed = clock::duration::zero();
+
+  while (elapsed < std::chrono::milliseconds(100)) {
+    setup();
+
+    const auto start = clock::now();
+    op();
+    elapsed += clock::now() - start;
+
+    calls++;
+  }
+
+  return std::make_pair(
+      std::chrono::duration<double, std::nano>(elapsed).count() / calls, calls);
+}
+
+int main(int argc, const char* argv[]) {
+  // sizes of the matrices (species x characters)
+  std::vector<std::pair<size_t, size_t>> sizes{
+      {32, 32}, {64, 64}, {128, 128}, {256, 256}};
+
+  if (argc > 1) {
+    sizes.clear();
+
+    for (int i = 1; i < argc; ++i) {
+      size_t species, characters;
+
+      if (std::sscanf(argv[i], "%zux%zu", &species, &characters) != 2 ||
+          species == 0 || characters == 0) {
+        std::fprintf(stderr, "Usage: %s [SPECIESxCHARACTERS...]\n", argv[0]);
+
+        return 1;
+      }
+
+      sizes.emplace_back(species, characters);
+    }
+  }
+
+  const std::string filename = "bench/primitives.txt";
+
+  std::printf("{\n  \"benchmarks\": [");
+
+  bool first = true;
+
+  for (const auto& size : sizes) {
+    PhylogenyParameters params;
+    params.species = size.first;
+    params.characters = size.second;
+    params.losses = size.second / 4;
+
+    std::mt19937_64 rng(0);
+    std::ofstream(filename) << random_matrix(params, rng);
+
+    RBGraph g;
+    read_graph(filename, g);
+
+    // g after the realization of its first species, with red edges
+    RBGraph g_red;
+    copy_graph(g, g_red);
+    realize(get_vertex("s0", g_red), g_red);
+
+    const auto gm = maximal_reducible_view(g);
+
+    // graph modified by the benchmark, rebuilt before each call
+    std::unique_ptr<RBGraph> g_test;
+    const auto copy_g = [&]() {
+      g_test.reset(new RBGraph);
+      copy_graph(g, *g_test);
+    };
+    const auto none = []() {};
+
+    const std::vector<std::tuple<const char*, std::function<void()>,
+                                 std::function<void()>>>
+        benchmarks{
+            {"read_graph",
+             [&]() { g_test.reset(new RBGraph); },
+             [&]() { read_graph(filename, *g_test); }},
+            {"copy_graph",
+             [&]() { g_test.reset(new RBGraph); },
+             [&]() { copy_graph(g, *g_test); }},
+            {"connected_components", none,
+             [&]() { connected_components(g); }},
+            // each vertex tested as in simplify
+            {"is_free/is_universal", none,
+             [&]() {
+               RBVertexIMap i_map, c_map;
+               RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
+
+               RBVertexIter v, v_end;
+               std::tie(v, v_end) = vertices(g);
+               for (size_t index = 0; v != v_end; ++v, ++index) {
+                 boost::put(i_assocmap, *v, index);
+               }
+
+               const auto c_count = boost::connected_components(
+                   g, c_assocmap, boost::vertex_index_map(i_assocmap));
+               const auto c_species = count_species(g, c_map, c_count);
+
+               std::tie(v, v_end) = vertices(g);
+               for (; v != v_end; ++v) {
+                 is_free(*v, g, c_map, c_species);
+                 is_universal(*v, g, c_map, c_species);
+               }
+             }},
+            {"maximal_characters", none, [&]() { maximal_characters(g); }},
+            {"hasse_diagram", none,
+             [&]() {
+               HDGraph hasse;
+               hasse_diagram(hasse, g, gm);
+             }},
+            {"has_red_sigmagraph", none, [&]() { has_red_sigmagraph(g_red); }},
+            {"realize", copy_g,
+             [&]() { realize(get_vertex("s0", *g_test), *g_test); }},
+            {"reduce", copy_g,
+             [&]() {
+               bitmatrix::enabled = false;
+
+               try {
+                 reduce(*g_test);
+               } catch (const NoReduction& e) {
+                 // timed all the same
+               }
+             }},
+            {"reduce/bitmatrix", copy_g,
+             [&]() {
+               bitmatrix::enabled = true;
+
+               try {
+                 reduce(*g_test);
+               } catch (const NoReduction& e) {
+                 // timed all the same
+               }
+             }},
+        };
+
+    for (const auto& benchmark : benchmarks) {
+      const auto result =
+          measure(std::get<1>(benchmark), std::get<2>(benchmark));
+
+      std::printf(
+          "%s\n    {\"name\": \"%s\", \"species\": %zu, \"characters\": %zu, "
+          "\"calls\": %zu, \"ns_per_call\": %.1f}",
+          first ? "" : ",", std::get<0>(benchmark), num_species(g),
+          num_characters(g), result.second, result.first);
+
+      first = false;
+    }
+  }
+
+  std::printf("\n  ]\n}\n");
+
+  std::remove(filename.c_str());
+
+  return 0;
+}
@@ -0,0 +1,349 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+#include "ppp.hpp"
+
+//=============================================================================
+// Python module ppp (make pymodule)
+//
+// The matrices are read in place through the buffer protocol (NumPy arrays of
+// uint8 or bool, memoryviews, ...), and reduced by libppp with the GIL
+// released.
+
+namespace {
+
+PyObject* search_limit_error = nullptr;
+
+/**
+  @brief Matrix read through the buffer protocol
+*/
+struct Matrix {
+  Py_buffer view{};                 ///< View of the object
+  bool acquired{};                  ///< The view must be released
+  const uint8_t* cells{};           ///< Cells, row by row
+  size_t species{};                 ///< Number of species (rows)
+  size_t characters{};              ///< Number of characters (columns)
+  size_t stride{};                  ///< Distance between the rows
+  std::vector<uint8_t> copy{};      ///< Cells, when the columns of the view
+                                    ///< are not contiguous
+  std::vector<ppp::Step> reduction{};  ///< Reduction
+  ppp::Status status{};                ///< Outcome of the reduction
+
+  Matrix() = default;
+  Matrix(const Matrix&) = delete;
+  Matrix& operator=(const Matrix&) = delete;
+
+  ~Matrix() {
+    if (acquired) PyBuffer_Release(&view);
+  }
+
+  /**
+    @brief Read the cells of \e object, a 2-D buffer of bytes
+
+    @return False with a Python exception set if \e object is not one
+  */
+  bool read(PyObject* object) {
+    if (PyObject_GetBuffer(object, &view, PyBUF_STRIDES | PyBUF_FORMAT) != 0)
+      return false;
+
+    acquired = true;
+
+    const std::string format(view.format != nullptr ? view.format : "B");
+
+    if (view.ndim != 2 || view.itemsize != 1 ||
+        (format != "B" && format != "?" && format != "b" && format != "c")) {
+      PyErr_SetString(PyExc_TypeError,
+                      "matrix must be a 2-D array of uint8 or bool");
+
+      return false;
+    }
+
+    species = view.shape[0];
+    characters = view.shape[1];
+
+    const auto row = view.strides[0], column = view.strides[1];
+    const auto data = static_cast<const uint8_t*>(view.buf);
+
+    if (column == 1 && row >= view.shape[1]) {
+      // rows of contiguous cells (e.g. a C-ordered array): no copy
+      cells = data;
+      stride = row;
+
+      return true;
+    }
+
+    copy.resize(species * characters);
+
+    // any other layout (transposed, Fortran-ordered, reversed, ...)
+    for (Py_ssize_t s = 0; s < view.shape[0]; ++s) {
+      for (Py_ssize_t c = 0; c < view.shape[1]; ++c) {
+        copy[s * characters + c] = data[s * row + c * column];
+      }
+    }
+
+    cells = copy.data();
+    stride = characters;
+
+    return true;
+  }
+
+  /**
+    @brief Reduce the matrix, without the GIL
+  */
+  void solve(const ppp::Options& options) {
+    status =
+        ppp::solve(cells, species, characters, stride, reduction, options);
+  }
+
+  /**
+    @brief Return the result of the reduction: the list of (character, gained)
+           pairs, None if there is no successful reduction, or a new reference
+           to an exception for the other outcomes (nullptr with the exception
+           set if \e raise)
+  */
+  PyObject* result(const bool raise) const {
+    switch (status) {
+      case ppp::Status::success: {
+        PyObject* output = PyList_New(reduction.size());
+
+        if (output == nullptr) return nullptr;
+
+        for (size_t i = 0; i < reduction.size(); ++i) {
+          PyList_SET_ITEM(output, i,
+                          Py_BuildValue("(kO)", static_cast<unsigned long>(
+                                                    reduction[i].character),
+                                        reduction[i].gain ? Py_True
+                                                          : Py_False));
+        }
+
+        return output;
+      }
+
+      case ppp::Status::no_reduction:
+        Py_RETURN_NONE;
+
+      default:
+        break;
+    }
+
+    PyObject* type = search_limit_error;
+    const char* message = "Search limit reached";
+
+    if (status == ppp::Status::invalid_argument) {
+      type = PyExc_ValueError;
+      message = "matrix must have at least one row and one column";
+    } else if (status == ppp::Status::error) {
+      type = PyExc_RuntimeError;
+      message = "Reduction rejected by the check";
+    }
+
+    if (raise) {
+      PyErr_SetString(type, message);
+
+      return nullptr;
+    }
+
+    return PyObject_CallFunction(type, "s", message);
+  }
+};
+
+/**
+  @brief Read the options of the algorithm in \e kwargs into \e options
+
+  @return False with a Python exception set if an option is unknown or bad
+*/
+bool read_options(PyObject* kwargs, ppp::Options& options,
+                  size_t* threads = nullptr) {
+  if (kwargs == nullptr) return true;
+
+  PyObject *key, *value;
+  Py_ssize_t pos = 0;
+
+  while (PyDict_Next(kwargs, &pos, &key, &value)) {
+    const char* name = PyUnicode_AsUTF8(key);
+
+    if (name == nullptr) return false;
+
+    const std::string option(name);
+    bool* flag = nullptr;
+
+    if (option == "maximal")
+      flag = &options.maximal;
+    else if (option == "check")
+      flag = &options.check;
+    else if (option == "kernel")
+      flag = &options.kernel;
+    else if (option == "exponential")
+      flag = &options.exponential;
+    else if (option == "first")
+      flag = &options.first;
+    else if (option == "bitmatrix")
+      flag = &options.bitmatrix;
+
+    if (flag != nullptr) {
+      const auto truth = PyObject_IsTrue(value);
+
+      if (truth < 0) return false;
+
+      *flag = truth;
+    } else if (option == "max_nodes" ||
+               (option == "threads" && threads != nullptr)) {
+      const auto n = PyLong_AsSize_t(value);
+
+      if (PyErr_Occurred()) return false;
+
+      if (option == "max_nodes")
+        options.max_nodes = n;
+      else
+        *threads = n;
+    } else if (option == "timeout") {
+      options.timeout = PyFloat_AsDouble(value);
+
+      if (PyErr_Occurred()) return false;
+    } else {
+      PyErr_Format(PyExc_TypeError, "unexpected keyword argument '%s'", name);
+
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PyObject* solve(PyObject* self, PyObject* args, PyObject* kwargs) {
+  PyObject* object;
+  ppp::Options options;
+
+  if (!PyArg_ParseTuple(args, "O:solve", &object) ||
+      !read_options(kwargs, options))
+    return nullptr;
+
+  Matrix m;
+
+  if (!m.read(object)) return nullptr;
+
+  Py_BEGIN_ALLOW_THREADS;
+  m.solve(options);
+  Py_END_ALLOW_THREADS;
+
+  return m.result(true);
+}
+
+PyObject* solve_batch(PyObject* self, PyObject* args, PyObject* kwargs) {
+  PyObject* objects;
+  ppp::Options options;
+  size_t threads = 0;
+
+  if (!PyArg_ParseTuple(args, "O:solve_batch", &objects) ||
+      !read_options(kwargs, options, &threads))
+    return nullptr;
+
+  PyObject* sequence =
+      PySequence_Fast(objects, "matrices must be a sequence of matrices");
+
+  if (sequence == nullptr) return nullptr;
+
+  const auto count = static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence));
+  std::vector<std::unique_ptr<Matrix>> matrices(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    matrices[i].reset(new Matrix());
+
+    if (!matrices[i]->read(PySequence_Fast_GET_ITEM(sequence, i))) {
+      Py_DECREF(sequence);
+
+      return nullptr;
+    }
+  }
+
+  if (threads == 0) threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool pool(std::min(threads, std::max<size_t>(count, 1)));
+  pool.run(count, [&](const size_t i) { matrices[i]->solve(options); });
+  Py_END_ALLOW_THREADS;
+
+  Py_DECREF(sequence);
+
+  PyObject* output = PyList_New(count);
+
+  if (output == nullptr) return nullptr;
+
+  for (size_t i = 0; i < count; ++i) {
+    PyObject* result = matrices[i]->result(false);
+
+    if (result == nullptr) {
+      Py_DECREF(output);
+
+      return nullptr;
+    }
+
+    PyList_SET_ITEM(output, i, result);
+  }
+
+  return output;
+}
+
+PyMethodDef methods[] = {
+    {"solve", reinterpret_cast<PyCFunction>(solve),
+     METH_VARARGS | METH_KEYWORDS,
+     "solve(matrix, **options)\n"
+     "--\n\n"
+     "Compute a successful c-reduction of matrix, a 2-D array of uint8 or "
+     "bool\n(species by characters), read in place.\n\n"
+     "Return the list of (character, gained) pairs of the reduction, or None "
+     "if\nthe matrix has none. Raise SearchLimit if the exponential search "
+     "reaches\nmax_nodes or timeout.\n\n"
+     "Options (as the ones of ppp): maximal, check, kernel, exponential, "
+     "first,\nmax_nodes, timeout, bitmatrix (default True)."},
+    {"solve_batch", reinterpret_cast<PyCFunction>(solve_batch),
+     METH_VARARGS | METH_KEYWORDS,
+     "solve_batch(matrices, threads=0, **options)\n"
+     "--\n\n"
+     "Reduce each matrix in matrices as solve does, with threads threads "
+     "(0 =\none per core).\n\n"
+     "Return the list of the results, in the order of matrices: a "
+     "SearchLimit\ninstance takes the place of the reductions that reach the "
+     "limit."},
+    {nullptr, nullptr, 0, nullptr}};
+
+PyModuleDef module = {PyModuleDef_HEAD_INIT,
+                      "ppp",
+                      "Persistent perfect phylogeny: reduce binary matrices "
+                      "held in memory (e.g.\nNumPy arrays) with libppp.",
+                      -1,
+                      methods,
+                      nullptr,
+                      nullptr,
+                      nullptr,
+                      nullptr};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_ppp(void) {
+  PyObject* m = PyModule_Create(&module);
+
+  if (m == nullptr) return nullptr;
+
+  search_limit_error =
+      PyErr_NewException("ppp.SearchLimit", PyExc_RuntimeError, nullptr);
+
+  if (search_limit_error == nullptr ||
+      PyModule_AddObject(m, "SearchLimit", search_limit_error) != 0) {
+    Py_XDECREF(search_limit_error);
+    Py_DECREF(m);
+
+    return nullptr;
+  }
+
+  // the module keeps a reference
+  Py_INCREF(search_limit_error);
+
+  return m;
+}
@@ -0,0 +1,366 @@
+#!/usr/bin/env python3
+
+"""Scaling benchmark of ppp.
+
+Generate corpora of increasing size with ppp-generate, run ppp --stats on each
+one, record the wall time, the peak RSS and the per-phase counters of each
+size, fit growth curves (time ~ characters^exponent), and compare them with a
+baseline saved by a previous run.
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+DIR = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(DIR)
+
+# lines of the stats report printed by ppp --stats
+PHASE_LINE = re.compile(r'^\s+(\w+)\s+([\d.]+) ms\s+(\d+) calls$')
+COUNTER_LINE = re.compile(r'^\s+(\w+)\s+(\d+)$')
+
+
+def generate(args, characters, directory):
+    # generate the corpus of the given size in directory, unless it exists
+    if os.path.isdir(directory) and os.listdir(directory):
+        return
+
+    species = max(1, int(round(characters * args.ratio)))
+
+    subprocess.run([args.generate,
+                    '--species', str(species),
+                    '--characters', str(characters),
+                    '--losses', str(characters // 4),
+                    '--solvable', str(args.solvable),
+                    '--unsolvable', str(args.unsolvable),
+                    '--flips', str(args.flips),
+                    '--seed', str(args.seed),
+                    directory], check=True)
+
+
+def run(args, files):
+    # run ppp once on files, return its wall time (ms), peak RSS (KB) and
+    # output: the output goes to temporary files, so that the process can be
+    # waited with wait4, which returns its resource usage
+    command = [args.ppp] + (['--stats'] if args.stats else []) + args.ppp_args
+
+    with tempfile.TemporaryFile('w+') as stdout, \
+            tempfile.TemporaryFile('w+') as stderr:
+        start = time.perf_counter()
+        process = subprocess.Popen(command + files, stdout=stdout,
+                                   stderr=stderr)
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = (time.perf_counter() - start) * 1000
+
+        process.returncode = os.waitstatus_to_exitcode(status)
+
+        if process.returncode != 0:
+            stderr.seek(0)
+            sys.exit('Error: {} failed:\n{}'.format(args.ppp,
+                                                    stderr.read().strip()))
+
+        stdout.seek(0)
+
+        return wall, usage.ru_maxrss, stdout.read().splitlines()
+
+
+def parse_stats(lines):
+    # parse the total report (the last one) printed by ppp --stats
+    phases, calls, counters = {}, {}, {}
+
+    try:
+        start = max(i for i, line in enumerate(lines)
+                    if line.startswith('Stats ('))
+    except ValueError:
+        return phases, calls, counters
+
+    for line in lines[start + 1:]:
+        match = PHASE_LINE.match(line)
+        if match:
+            phases[match.group(1)] = float(match.group(2))
+            calls[match.group(1)] = int(match.group(3))
+            continue
+
+        match = COUNTER_LINE.match(line)
+        if match:
+            counters[match.group(1)] = int(match.group(2))
+
+    return phases, calls, counters
+
+
+def measure(args, characters, directory):
+    # measure ppp on the corpus in directory, keep the fastest of the runs
+    files = sorted(os.path.join(directory, name)
+                   for name in os.listdir(directory) if name.endswith('.txt'))
+    result = None
+
+    for _ in range(args.repeat):
+        wall, peak_rss, lines = run(args, files)
+        phases, calls, counters = parse_stats(lines)
+        current = {
+            'characters': characters,
+            'instances': len(files),
+            'wall_ms': wall,
+            'peak_rss_kb': peak_rss,
+            'phases_ms': phases,
+            'calls': calls,
+            'counters': counters,
+        }
+
+        if result is None:
+            result = current
+            continue
+
+        # the counters don't change between runs, the times do
+        result['wall_ms'] = min(result['wall_ms'], current['wall_ms'])
+        result['peak_rss_kb'] = min(result['peak_rss_kb'],
+                                    current['peak_rss_kb'])
+        for name, value in phases.items():
+            result['phases_ms'][name] = min(result['phases_ms'][name], value)
+
+    return result
+
+
+def metrics(result):
+    # flat map of the metrics of a size, the ones that are fit and compared
+    output = {'wall_ms': result['wall_ms'],
+              'peak_rss_kb': result['peak_rss_kb']}
+
+    for name, value in result['phases_ms'].items():
+        output['phase.' + name] = value
+    for name, value in result['counters'].items():
+        output['counter.' + name] = value
+
+    return output
+
+
+def fit(results):
+    # least squares fit of log(metric) = log(coefficient) + exponent *
+    # log(characters), for each metric positive in at least two sizes
+    points = {}
+
+    for result in results:
+        for name, value in metrics(result).items():
+            if value > 0:
+                points.setdefault(name, []).append(
+                    (math.log(result['characters']), math.log(value)))
+
+    fits = {}
+
+    for name, xy in sorted(points.items()):
+        if len(xy) < 2:
+            continue
+
+        n = len(xy)
+        mean_x = sum(x for x, _ in xy) / n
+        mean_y = sum(y for _, y in xy) / n
+        var_x = sum((x - mean_x) ** 2 for x, _ in xy)
+
+        if var_x == 0:
+            continue
+
+        exponent = sum((x - mean_x) * (y - mean_y) for x, y in xy) / var_x
+        fits[name] = {
+            'exponent': exponent,
+            'coefficient': math.exp(mean_y - exponent * mean_x),
+            'sizes': n,
+        }
+
+    return fits
+
+
+def compare(args, current, baseline):
+    # list the regressions of current with respect to baseline
+    regressions = []
+
+    if current['parameters'] != baseline.get('parameters'):
+        print('Warning: the baseline was run with different parameters, '
+              'the comparison may be meaningless.', file=sys.stderr)
+
+    old_results = {r['characters']: r for r in baseline['results']}
+
+    print('\n{:<26} {:>6} {:>14} {:>14} {:>9}'.format(
+        'Metric', 'Size', 'Baseline', 'Current', 'Change'))
+
+    for result in current['results']:
+        old = old_results.get(result['characters'])
+        if old is None:
+            continue
+
+        old_metrics = metrics(old)
+
+        for name, value in sorted(metrics(result).items()):
+            if name not in old_metrics:
+                continue
+
+            old_value = old_metrics[name]
+
+            # times too short to be measured reliably are skipped
+            if (name == 'wall_ms' or name.startswith('phase.')) and \
+                    max(value, old_value) < args.min_ms:
+                continue
+
+            if old_value == 0:
+                change = math.inf if value > 0 else 0.0
+            else:
+                change = value / old_value - 1
+
+            flag = ''
+            if change > args.threshold:
+                flag = '  REGRESSION'
+                regressions.append((name, result['characters']))
+            elif change < -args.threshold:
+                flag = '  improvement'
+
+            if flag or args.verbose:
+                print('{:<26} {:>6} {:>14.6g} {:>14.6g} {:>+8.1%}{}'.format(
+                    name, result['characters'], old_value, value, change,
+                    flag))
+
+    print('\n{:<26} {:>9} {:>9} {:>9}'.format(
+        'Growth', 'Baseline', 'Current', 'Change'))
+
+    for name, current_fit in sorted(current['fits'].items()):
+        old_fit = baseline.get('fits', {}).get(name)
+        if old_fit is None:
+            continue
+
+        delta = current_fit['exponent'] - old_fit['exponent']
+
+        flag = ''
+        if delta > args.exponent_threshold:
+            flag = '  REGRESSION'
+            regressions.append((name, 'exponent'))
+        elif delta < -args.exponent_threshold:
+            flag = '  improvement'
+
+        if flag or args.verbose:
+            print('{:<26} {:>9.2f} {:>9.2f} {:>+9.2f}{}'.format(
+                name, old_fit['exponent'], current_fit['exponent'], delta,
+                flag))
+
+    return regressions
+
+
+def report(output):
+    # print the measures and the growth curves of output
+    print('{:>6} {:>9} {:>12} {:>12} {:>14}'.format(
+        'Size', 'Files', 'Wall (ms)', 'ms/file', 'Peak RSS (KB)'))
+
+    for result in output['results']:
+        print('{:>6} {:>9} {:>12.1f} {:>12.3f} {:>14}'.format(
+            result['characters'], result['instances'], result['wall_ms'],
+            result['wall_ms'] / result['instances'], result['peak_rss_kb']))
+
+    print('\n{:<26} {:>9}'.format('Growth', 'Exponent'))
+
+    for name, value in output['fits'].items():
+        print('{:<26} {:>9.2f}'.format(name, value['exponent']))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(
+        description='Run ppp on generated corpora of increasing size, fit the '
+                    'growth of its wall time, peak RSS and per-phase stats, '
+                    'and compare them with a baseline.',
+        epilog='Arguments after -- are passed to ppp (e.g. -- --no-bitmatrix).')
+    parser.add_argument('--ppp', default=os.path.join(ROOT, 'bin', 'ppp'),
+                        help='ppp binary (default: bin/ppp)')
+    parser.add_argument('--generate',
+                        default=os.path.join(ROOT, 'bin', 'ppp-generate'),
+                        help='ppp-generate binary (default: bin/ppp-generate)')
+    parser.add_argument('--sizes', type=int, nargs='+',
+                        default=[10, 20, 40, 80, 160, 320],
+                        help='numbers of characters (default: 10 20 40 80 '
+                             '160 320)')
+    parser.add_argument('--ratio', type=float, default=1.0,
+                        help='species per character (default: 1)')
+    parser.add_argument('--solvable', type=int, default=10,
+                        help='matrices with a persistent phylogeny per size '
+                             '(default: 10)')
+    parser.add_argument('--unsolvable', type=int, default=5,
+                        help='matrices without a persistent phylogeny per '
+                             'size (default: 5)')
+    parser.add_argument('--flips', type=int, default=3,
+                        help='cells flipped in the unsolvable matrices '
+                             '(default: 3)')
+    parser.add_argument('--seed', type=int, default=0,
+                        help='seed of the corpora (default: 0)')
+    parser.add_argument('--corpus',
+                        help='directory of the corpora, kept and reused '
+                             '(default: a temporary directory)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per size, the fastest is kept '
+                             '(default: 3)')
+    parser.add_argument('--no-stats', dest='stats', action='store_false',
+                        help="don't pass --stats to ppp (for builds without "
+                             'it)')
+    parser.add_argument('--output', help='save the results to this JSON file')
+    parser.add_argument('--baseline',
+                        help='compare the results with this JSON file')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='relative increase of a metric flagged as a '
+                             'regression (default: 0.1)')
+    parser.add_argument('--exponent-threshold', type=float, default=0.25,
+                        help='increase of a growth exponent flagged as a '
+                             'regression (default: 0.25)')
+    parser.add_argument('--min-ms', type=float, default=5.0,
+                        help='times below this are not compared '
+                             '(default: 5)')
+    parser.add_argument('--verbose', '-v', action='store_true',
+                        help='print every compared metric')
+    parser.add_argument('ppp_args', nargs=argparse.REMAINDER,
+                        help=argparse.SUPPRESS)
+
+    args = parser.parse_args()
+
+    if args.ppp_args and args.ppp_args[0] == '--':
+        args.ppp_args = args.ppp_args[1:]
+
+    with tempfile.TemporaryDirectory() as temp:
+        corpus = args.corpus or temp
+
+        results = []
+        for characters in args.sizes:
+            directory = os.path.join(corpus, str(characters))
+            os.makedirs(os.path.dirname(directory), exist_ok=True)
+
+            generate(args, characters, directory)
+            results.append(measure(args, characters, directory))
+
+    output = {
+        'parameters': {
+            'sizes': args.sizes,
+            'ratio': args.ratio,
+            'solvable': args.solvable,
+            'unsolvable': args.unsolvable,
+            'flips': args.flips,
+            'seed': args.seed,
+            'ppp_args': args.ppp_args,
+        },
+        'results': results,
+        'fits': fit(results),
+    }
+
+    report(output)
+
+    if args.output:
+        with open(args.output, 'w') as file:
+            json.dump(output, file, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+
+        regressions = compare(args, output, baseline)
+
+        print('\n{} regression(s) beyond the thresholds.'.format(
+            len(regressions)))
+
+        sys.exit(1 if regressions else 0)
@@ -0,0 +1,71 @@
+#include "arena.hpp"
+#include <boost/container/pmr/global_resource.hpp>
+
+namespace {
+
+/**
+  Arena of the innermost scratch scope of the thread
+*/
+thread_local scratch_arena* current_arena = nullptr;
+
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+scratch_arena::scratch_arena() : m_pools(&m_heap) {}
+
+void scratch_arena::release() { m_pools.release(); }
+
+void* scratch_arena::do_allocate(size_t bytes, size_t alignment) {
+  m_allocations++;
+  m_bytes += bytes;
+
+  return m_pools.allocate(bytes, alignment);
+}
+
+void scratch_arena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  m_pools.deallocate(p, bytes, alignment);
+}
+
+bool scratch_arena::do_is_equal(
+    const boost::container::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+void* scratch_arena::counting_resource::do_allocate(size_t bytes,
+                                                    size_t alignment) {
+  blocks++;
+  this->bytes += bytes;
+
+  return boost::container::pmr::new_delete_resource()->allocate(bytes,
+                                                                alignment);
+}
+
+void scratch_arena::counting_resource::do_deallocate(void* p, size_t bytes,
+                                                     size_t alignment) {
+  boost::container::pmr::new_delete_resource()->deallocate(p, bytes,
+                                                           alignment);
+}
+
+bool scratch_arena::counting_resource::do_is_equal(
+    const boost::container::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+scratch_scope::scratch_scope(scratch_arena& arena)
+    : m_previous{current_arena} {
+  current_arena = &arena;
+}
+
+scratch_scope::~scratch_scope() { current_arena = m_previous; }
+
+//=============================================================================
+// General functions
+
+boost::container::pmr::memory_resource* scratch() {
+  if (current_arena == nullptr)
+    return boost::container::pmr::new_delete_resource();
+
+  return current_arena;
+}
@@ -0,0 +1,126 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/unsynchronized_pool_resource.hpp>
+#include <cstddef>
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Memory resource backing the transient data structures of a reduction
+         (index maps, lists of vertices, ...), through pmr containers
+
+  The memory is taken from the heap in large blocks, split into pools of
+  blocks of the same size: a freed block is reused by the next allocation of
+  the same size, so the scratch containers of each reduce level don't call
+  malloc and free. The blocks go back to the heap in one shot, with release or
+  when the arena is destroyed.
+  An arena is not thread safe: each thread uses its own (see scratch_scope).
+*/
+class scratch_arena : public boost::container::pmr::memory_resource {
+ public:
+  /**
+    @brief Empty arena constructor
+  */
+  scratch_arena();
+
+  scratch_arena(const scratch_arena&) = delete;
+  scratch_arena& operator=(const scratch_arena&) = delete;
+
+  /**
+    @brief Give back the memory of the arena to the heap, the containers that
+           use it must have been destroyed
+  */
+  void release();
+
+  /**
+    @brief Return the number of allocations served by the arena
+  */
+  inline size_t allocations() const { return m_allocations; }
+
+  /**
+    @brief Return the number of bytes of the allocations served by the arena
+  */
+  inline size_t bytes() const { return m_bytes; }
+
+  /**
+    @brief Return the number of blocks of memory taken from the heap
+  */
+  inline size_t heap_blocks() const { return m_heap.blocks; }
+
+  /**
+    @brief Return the number of bytes of the blocks taken from the heap
+  */
+  inline size_t heap_bytes() const { return m_heap.bytes; }
+
+ private:
+  /**
+    @brief Heap, counting the blocks taken from it
+  */
+  struct counting_resource : public boost::container::pmr::memory_resource {
+    size_t blocks{};  ///< Number of allocations
+    size_t bytes{};   ///< Number of bytes allocated
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(
+        const boost::container::pmr::memory_resource& other) const
+        noexcept override;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const boost::container::pmr::memory_resource& other) const
+      noexcept override;
+
+  counting_resource m_heap{};
+  boost::container::pmr::unsynchronized_pool_resource m_pools;
+  size_t m_allocations{};
+  size_t m_bytes{};
+};
+
+/**
+  @brief Scope in which the transient data structures of the calling thread
+         are allocated in an arena (see scratch)
+
+  Scopes can be nested, the previous arena of the thread is restored when the
+  scope ends.
+*/
+class scratch_scope {
+ public:
+  /**
+    @brief Scratch scope constructor
+
+    @param[in] arena Arena used by the calling thread until the scope ends
+  */
+  explicit scratch_scope(scratch_arena& arena);
+
+  /**
+    @brief Scratch scope destructor, restores the previous arena
+  */
+  ~scratch_scope();
+
+  scratch_scope(const scratch_scope&) = delete;
+  scratch_scope& operator=(const scratch_scope&) = delete;
+
+ private:
+  scratch_arena* const m_previous{};
+};
+
+//=============================================================================
+// General functions
+
+/**
+  @brief Return the memory resource for the transient data structures of the
+         calling thread: the arena of its innermost scratch scope, or the heap
+         if there is none
+
+  A container built with it must be destroyed before the scope ends.
+
+  @return Memory resource
+*/
+boost::container::pmr::memory_resource* scratch();
+
+#endif
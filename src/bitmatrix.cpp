@@ -0,0 +1,669 @@
+#include "bitmatrix.hpp"
+
+//=============================================================================
+// BitMatrix
+
+template <size_t W>
+BitMatrix<W>::BitMatrix(const RBGraph& g) {
+  RBVertexIMap index(scratch());
+
+  // index the species and the characters in vertex order
+  size_t count_species = 0, count_characters = 0;
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_species(*v, g)) {
+      species.set(count_species);
+      index[*v] = count_species++;
+    } else {
+      characters.set(count_characters);
+      index[*v] = count_characters++;
+    }
+  }
+
+  // store the edges of each character
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (!is_character(*v, g)) continue;
+
+    const auto c = index.at(*v);
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      const auto s = index.at(target(*e, g));
+
+      if (is_red(*e, g))
+        red[c].set(s);
+      else
+        black[c].set(s);
+    }
+  }
+}
+
+template <size_t W>
+std::pair<std::list<SignedCharacter>, bool> BitMatrix<W>::reduce(
+    const RBGraph& g) {
+  std::list<SignedCharacter> output;
+
+  // names of the characters, by index
+  std::vector<std::string> names;
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_character(*v, g)) names.push_back(g[*v].name);
+  }
+
+  BitMatrix m(g);
+  BitReduction<W> reduction;
+
+  if (!m.reduce(reduction)) return std::make_pair(output, false);
+
+  for (size_t i = 0; i < reduction.size; ++i) {
+    output.push_back({names[reduction.steps[i]], reduction.states[i]});
+  }
+
+  return std::make_pair(output, true);
+}
+
+template <size_t W>
+void BitMatrix<W>::component(Set& c_species, Set& c_characters) const {
+  for (auto c = c_characters.first(); c < capacity;
+       c = c_characters.next(c + 1)) {
+    c_species |= black[c] | red[c];
+  }
+
+  // add the characters connected to the species of the component (and their
+  // species) until there are none left
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+
+    const auto left = characters - c_characters;
+
+    for (auto c = left.first(); c < capacity; c = left.next(c + 1)) {
+      const auto c_adj = black[c] | red[c];
+
+      if (!c_adj.intersects(c_species)) continue;
+
+      c_characters.set(c);
+      c_species |= c_adj;
+
+      changed = true;
+    }
+  }
+}
+
+template <size_t W>
+void BitMatrix<W>::remove_singletons() {
+  Set connected;
+
+  const auto all = characters;
+
+  for (auto c = all.first(); c < capacity; c = all.next(c + 1)) {
+    const auto c_adj = black[c] | red[c];
+
+    if (c_adj.none())
+      characters.reset(c);
+    else
+      connected |= c_adj;
+  }
+
+  species = species & connected;
+}
+
+template <size_t W>
+bool BitMatrix<W>::is_closed(const Set& s) const {
+  // each character is connected only by black edges or only by red edges, so
+  // it's enough to look for a character whose black (or red) species straddle
+  // s
+  return find_row(SetRelation::straddles, black, characters, 0, s) ==
+             capacity &&
+         find_row(SetRelation::straddles, red, characters, 0, s) == capacity;
+}
+
+template <size_t W>
+bool BitMatrix<W>::realize_character(const size_t c, const State state) {
+  if (!characters.test(c)) return false;
+
+  if (state == State::gain && is_inactive(c)) {
+    // realize the character c+:
+    // - add a red edge between c and each species in D(c) \ N(c)
+    // - delete all black edges incident on c
+    Set c_species, c_characters;
+    c_characters.set(c);
+    component(c_species, c_characters);
+
+    red[c] = c_species - black[c];
+    black[c] = Set();
+  } else if (state == State::lose && is_active(c)) {
+    // realize the character c-:
+    // - delete all edges incident on c
+    red[c] = Set();
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+template <size_t W>
+void BitMatrix<W>::simplify(BitReduction<W>& output) {
+  remove_singletons();
+
+  while (species.any()) {
+    // find the first free character, or else the first universal character
+    size_t free_char = capacity, universal_char = capacity;
+
+    for (auto c = characters.first(); c < capacity;
+         c = characters.next(c + 1)) {
+      if (is_free(c)) {
+        free_char = c;
+
+        break;
+      }
+
+      if (universal_char == capacity && is_universal(c)) universal_char = c;
+    }
+
+    if (free_char < capacity) {
+      realize_character(free_char, State::lose);
+      output.push(free_char, State::lose);
+    } else if (universal_char < capacity) {
+      realize_character(universal_char, State::gain);
+      output.push(universal_char, State::gain);
+    } else {
+      // no free or universal characters left
+      break;
+    }
+
+    remove_singletons();
+  }
+}
+
+template <size_t W>
+bool BitMatrix<W>::realize(const size_t c, const State state,
+                           BitReduction<W>& output) {
+  if (!realize_character(c, state)) return false;
+
+  output.push(c, state);
+
+  simplify(output);
+
+  return true;
+}
+
+template <size_t W>
+bool BitMatrix<W>::realize(const Set& lsc, BitReduction<W>& output) {
+  for (auto c = lsc.first(); c < capacity; c = lsc.next(c + 1)) {
+    if (output.gained.test(c))
+      // c+ has already been realized
+      continue;
+
+    if (!realize(c, State::gain, output)) return false;
+  }
+
+  return true;
+}
+
+template <size_t W>
+typename BitMatrix<W>::Set BitMatrix<W>::maximal_characters() const {
+  Set cm;
+
+  for (auto c = characters.first(); c < capacity; c = characters.next(c + 1)) {
+    if (!is_inactive(c) || black[c].none()) continue;
+    // for each inactive character
+
+    bool maximal = true;
+
+    for (auto d = find_row(SetRelation::superset, black, characters, 0,
+                           black[c]);
+         d < capacity && maximal;
+         d = find_row(SetRelation::superset, black, characters, d + 1,
+                      black[c])) {
+      if (d == c) continue;
+
+      // c is not maximal if d is a superset or an earlier duplicate
+      if (black[c] != black[d] || d < c) maximal = false;
+    }
+
+    if (maximal) cm.set(c);
+  }
+
+  return cm;
+}
+
+template <size_t W>
+BitMatrix<W> BitMatrix<W>::maximal_reducible_graph(const Set& cm) const {
+  BitMatrix gm(*this);
+  gm.species = Set();
+  gm.characters = Set();
+
+  // keep the maximal (and active) characters, with their species
+  for (auto c = characters.first(); c < capacity; c = characters.next(c + 1)) {
+    if (!is_active(c) && !cm.test(c)) continue;
+
+    const auto c_adj = black[c] | red[c];
+
+    if (c_adj.none())
+      // singleton character
+      continue;
+
+    gm.characters.set(c);
+    gm.species |= c_adj;
+  }
+
+  return gm;
+}
+
+template <size_t W>
+bool BitMatrix<W>::has_red_sigmagraph() const {
+  stats::count(stats::Counter::sigma_tests);
+
+  Set active;
+
+  for (auto c = characters.first(); c < capacity; c = characters.next(c + 1)) {
+    if (is_active(c)) active.set(c);
+  }
+
+  // two active characters c0 and c1 induce a red Σ-graph if they share a
+  // species, and each one has a species the other one hasn't
+  for (auto c0 = active.first(); c0 < capacity; c0 = active.next(c0 + 1)) {
+    if (find_row(SetRelation::crosses, red, active, c0 + 1, red[c0]) <
+        capacity)
+      return true;
+  }
+
+  return false;
+}
+
+template <size_t W>
+bool BitMatrix<W>::reduce(BitReduction<W>& output) {
+  while (true) {
+    // cleanup the matrix, realize free and universal characters
+    simplify(output);
+
+    if (species.none())
+      // the matrix is empty
+      return true;
+
+    Set c_species, c_characters;
+    c_species.set(species.first());
+    component(c_species, c_characters);
+
+    if (c_species != species) {
+      // the matrix is not connected: reduce each connected component, in the
+      // order of their first species, restricting the matrix to it (the
+      // realizations in a component don't touch the other ones)
+      auto left_species = species;
+      auto left_characters = characters;
+
+      while (left_species.any()) {
+        species = left_species;
+        characters = left_characters;
+
+        c_species = Set();
+        c_characters = Set();
+        c_species.set(left_species.first());
+        component(c_species, c_characters);
+
+        left_species = left_species - c_species;
+        left_characters = left_characters - c_characters;
+
+        species = c_species;
+        characters = c_characters;
+
+        if (!reduce(output)) return false;
+      }
+
+      return true;
+    }
+
+    if (!reduce_step(output)) return false;
+  }
+}
+
+template <size_t W>
+bool BitMatrix<W>::reduce_step(BitReduction<W>& output) {
+  // gm = maximal reducible graph, p = Hasse diagram for gm
+  const auto gm = maximal_reducible_graph(maximal_characters());
+  const BitHasse<W> p(gm);
+
+  const auto source = safe_source(gm, p);
+
+  if (source == p.size)
+    // p has no safe source
+    return false;
+
+  // realize the characters of the safe source
+  BitReduction<W> lsc;
+
+  if (realize(p.characters[source], lsc)) output.append(lsc);
+
+  return true;
+}
+
+template <size_t W>
+size_t BitMatrix<W>::safe_source(const BitMatrix& gm,
+                                 const BitHasse<W>& hasse) const {
+  // species of gm connected to active characters
+  Set red_species;
+
+  for (auto c = gm.characters.first(); c < capacity;
+       c = gm.characters.next(c + 1)) {
+    red_species |= gm.red[c];
+  }
+
+  // sources with a safe chain and a feasible realization that failed test 1
+  std::array<uint16_t, capacity> sources{};
+  size_t count_sources = 0;
+
+  for (size_t v = 0; v < hasse.size; ++v) {
+    if (!hasse.is_source(v)) continue;
+    // for each source of the diagram
+
+    if (hasse.covers(v).any()) {
+      // the chains of v start with the realization of its characters
+      auto state = gm;
+      BitReduction<W> realized;
+
+      if (!state.realize(hasse.characters[v], realized) ||
+          !safe_chain(v, state, realized, hasse))
+        // v has no safe chain
+        continue;
+    }
+
+    if (!realize_source(v, hasse)) continue;
+
+    // test 1: a species of v is connected to only inactive characters
+    if ((hasse.species[v] - red_species).any()) return v;
+
+    sources[count_sources++] = v;
+  }
+
+  if (count_sources == 1)
+    return realize_source(sources[0], hasse) ? sources[0] : hasse.size;
+
+  if (count_sources == 0) return hasse.size;
+
+  // test 2: a species of gm, not in the source, consists of the characters of
+  // the source and of other maximal characters, and is connected to only
+  // inactive characters
+  for (size_t i = 0; i < count_sources; ++i) {
+    const auto v = sources[i];
+    const auto s_left = gm.species - hasse.species[v];
+
+    for (auto s = s_left.first(); s < capacity; s = s_left.next(s + 1)) {
+      if (red_species.test(s)) continue;
+
+      Set s_characters;
+
+      for (auto c = gm.characters.first(); c < capacity;
+           c = gm.characters.next(c + 1)) {
+        if (gm.black[c].test(s)) s_characters.set(c);
+      }
+
+      if (hasse.characters[v].is_subset_of(s_characters) &&
+          (s_characters - hasse.characters[v]).any())
+        return v;
+    }
+  }
+
+  // test 3: the source whose species are connected to the least number of
+  // active characters, if every species of the sources is connected to some
+  size_t output = hasse.size, min_active_count = 0;
+
+  for (size_t i = 0; i < count_sources; ++i) {
+    const auto v = sources[i];
+    size_t v_active_count = 0;
+
+    for (auto s = hasse.species[v].first(); s < capacity;
+         s = hasse.species[v].next(s + 1)) {
+      size_t active_count = 0;
+
+      for (auto c = gm.characters.first(); c < capacity;
+           c = gm.characters.next(c + 1)) {
+        if (gm.red[c].test(s)) active_count++;
+      }
+
+      if (active_count == 0) return hasse.size;
+
+      if (v_active_count == 0 || active_count < v_active_count)
+        v_active_count = active_count;
+    }
+
+    if (output == hasse.size || v_active_count < min_active_count) {
+      output = v;
+      min_active_count = v_active_count;
+    }
+  }
+
+  return output;
+}
+
+template <size_t W>
+bool BitMatrix<W>::realize_source(const size_t v,
+                                  const BitHasse<W>& hasse) const {
+  auto g_test = *this;
+  BitReduction<W> realized;
+
+  if (!g_test.realize(hasse.characters[v], realized)) return false;
+
+  // if the realization didn't induce a red Σ-graph, v is a safe source
+  return !g_test.has_red_sigmagraph();
+}
+
+template <size_t W>
+bool BitMatrix<W>::safe_chain(const size_t v, const BitMatrix& gm,
+                              const BitReduction<W>& realized,
+                              const BitHasse<W>& hasse) {
+  const auto covers = hasse.covers(v);
+
+  for (auto u = covers.first(); u < capacity; u = covers.next(u + 1)) {
+    // extend the chain with the characters gained from v to u
+    auto state = gm;
+    auto u_realized = realized;
+
+    if (!state.realize(hasse.characters[u] - hasse.characters[v], u_realized))
+      // no chain through (v, u) is feasible
+      continue;
+
+    if (hasse.covers(u).any()) {
+      // u is not a sink, keep going
+      if (safe_chain(u, state, u_realized, hasse)) return true;
+
+      continue;
+    }
+
+    // u is a sink: if the realization didn't induce a red Σ-graph, the chain
+    // is a safe chain
+    if (!state.has_red_sigmagraph()) return true;
+  }
+
+  return false;
+}
+
+//=============================================================================
+// BitHasse
+
+template <size_t W>
+BitHasse<W>::BitHasse(const BitMatrix<W>& gm) {
+  constexpr auto capacity = Set::capacity;
+
+  // inactive characters of each species of gm
+  std::array<Set, capacity> s_characters{};
+
+  for (auto c = gm.characters.first(); c < capacity;
+       c = gm.characters.next(c + 1)) {
+    if (!gm.is_inactive(c)) continue;
+
+    for (auto s = gm.black[c].first(); s < capacity;
+         s = gm.black[c].next(s + 1)) {
+      s_characters[s].set(c);
+    }
+  }
+
+  // species with characters, sorted by number of characters in ascending
+  // order (stable insertion sort, as the species are already in vertex order)
+  std::array<uint16_t, capacity> order{};
+  std::array<uint16_t, capacity> count{};
+  size_t count_species = 0;
+
+  for (auto s = gm.species.first(); s < capacity; s = gm.species.next(s + 1)) {
+    if (s_characters[s].none()) continue;
+
+    const auto s_count = s_characters[s].count();
+
+    auto i = count_species++;
+
+    for (; i > 0 && count[i - 1] > s_count; --i) {
+      order[i] = order[i - 1];
+      count[i] = count[i - 1];
+    }
+
+    order[i] = s;
+    count[i] = s_count;
+  }
+
+  // a vertex for each set of characters, in order of appearance
+  std::array<uint16_t, capacity> v_count{};
+
+  for (size_t i = 0; i < count_species; ++i) {
+    const auto s = order[i];
+
+    // the vertices with the same characters have the same number of
+    // characters, so they are at the end of the diagram
+    auto v = size;
+
+    for (auto u = size; u > 0 && v_count[u - 1] == count[i]; --u) {
+      if (characters[u - 1] == s_characters[s]) {
+        v = u - 1;
+
+        break;
+      }
+    }
+
+    if (v < size) {
+      // there is a vertex with the same characters as s, add s to it
+      species[v].set(s);
+
+      continue;
+    }
+
+    characters[size] = s_characters[s];
+    species[size].set(s);
+    v_count[size] = count[i];
+    size++;
+  }
+}
+
+template <size_t W>
+bool BitHasse<W>::is_source(const size_t v) const {
+  // the vertices whose characters are included in the ones of v come before it
+  for (size_t u = 0; u < v; ++u) {
+    if (is_strict_subset(characters[u], characters[v])) return false;
+  }
+
+  return true;
+}
+
+template <size_t W>
+typename BitHasse<W>::Set BitHasse<W>::covers(const size_t v) const {
+  Set output;
+
+  // a vertex u is minimal if it doesn't include the characters of an earlier
+  // minimal vertex
+  for (auto u = v + 1; u < size; ++u) {
+    if (!is_strict_subset(characters[v], characters[u])) continue;
+
+    bool cover = true;
+
+    for (auto w = output.first(); w < Set::capacity; w = output.next(w + 1)) {
+      if (is_strict_subset(characters[w], characters[u])) {
+        cover = false;
+
+        break;
+      }
+    }
+
+    if (cover) output.set(u);
+  }
+
+  return output;
+}
+
+template class BitMatrix<1>;
+template class BitMatrix<2>;
+template class BitMatrix<4>;
+template class BitHasse<1>;
+template class BitHasse<2>;
+template class BitHasse<4>;
+
+//=============================================================================
+// Algorithm functions
+
+bool fits_bitmatrix(const RBGraph& g) {
+  if (num_species(g) > BitMatrix<4>::capacity ||
+      num_characters(g) > BitMatrix<4>::capacity)
+    return false;
+
+  // number in the name of the last species and character
+  long last_species = -1, last_character = -1;
+  bool characters_started = false;
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    const auto& name = g[*v].name;
+
+    if (name.size() < 2 || name.size() > 10 ||
+        name.find_first_not_of("0123456789", 1) != std::string::npos)
+      // the order of the names is not the one of the numbers in them
+      return false;
+
+    const auto number = std::stol(name.substr(1));
+
+    if (is_species(*v, g)) {
+      if (characters_started || number <= last_species) return false;
+
+      last_species = number;
+
+      continue;
+    }
+
+    if (number <= last_character) return false;
+
+    last_character = number;
+    characters_started = true;
+
+    // the edges of the character must be all black or all red
+    size_t count_red = 0;
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      if (!is_species(target(*e, g), g)) return false;
+
+      if (is_red(*e, g)) count_red++;
+    }
+
+    if (count_red > 0 && count_red < out_degree(*v, g)) return false;
+  }
+
+  return true;
+}
+
+std::pair<std::list<SignedCharacter>, bool> reduce_bitmatrix(const RBGraph& g) {
+  if (num_species(g) <= BitMatrix<1>::capacity &&
+      num_characters(g) <= BitMatrix<1>::capacity)
+    return BitMatrix<1>::reduce(g);
+
+  if (num_species(g) <= BitMatrix<2>::capacity &&
+      num_characters(g) <= BitMatrix<2>::capacity)
+    return BitMatrix<2>::reduce(g);
+
+  return BitMatrix<4>::reduce(g);
+}
@@ -0,0 +1,575 @@
+#ifndef BITMATRIX_HPP
+#define BITMATRIX_HPP
+
+#include <array>
+#include <cstdint>
+#include "hdgraph.hpp"
+#include "simd.hpp"
+
+//=============================================================================
+// Data structures
+
+/**
+  @brief Set of at most 64 * W indexes (species or characters), stored in W
+         64-bit words
+
+  The operations on single sets are inline loops. The scans of a matrix of sets
+  (see find_row) of 4 words or more go through the SIMD kernels selected at
+  runtime (see set_kernels).
+*/
+template <size_t W>
+struct BitSet {
+  static constexpr size_t capacity = 64 * W;  ///< Maximum number of indexes
+  static constexpr bool vectorized = W >= 4;  ///< Use the SIMD kernels
+                                              ///< (see find_row)
+
+  std::array<uint64_t, W> words{};  ///< Bit i % 64 of word i / 64 is set if i
+                                    ///< is in the set
+
+  /**
+    @brief Check if \e i is in the set
+  */
+  inline bool test(const size_t i) const {
+    return (words[i / 64] >> (i % 64)) & 1;
+  }
+
+  /**
+    @brief Add \e i to the set
+  */
+  inline void set(const size_t i) { words[i / 64] |= uint64_t(1) << (i % 64); }
+
+  /**
+    @brief Remove \e i from the set
+  */
+  inline void reset(const size_t i) {
+    words[i / 64] &= ~(uint64_t(1) << (i % 64));
+  }
+
+  /**
+    @brief Check if the set is empty
+  */
+  inline bool none() const {
+    for (const auto& word : words) {
+      if (word != 0) return false;
+    }
+
+    return true;
+  }
+
+  /**
+    @brief Check if the set is not empty
+  */
+  inline bool any() const { return !none(); }
+
+  /**
+    @brief Return the number of indexes in the set
+  */
+  inline size_t count() const {
+    // without the popcnt instruction each word takes a call
+    if (vectorized) return set_kernels().popcount(data(), W);
+
+    size_t output = 0;
+
+    for (const auto& word : words) {
+      output += __builtin_popcountll(word);
+    }
+
+    return output;
+  }
+
+  /**
+    @brief Return the first index in the set that is not less than \e i, or
+           \e capacity if there is none
+
+    The indexes of a set s are visited with:
+    for (auto i = s.first(); i < s.capacity; i = s.next(i + 1))
+  */
+  inline size_t next(const size_t i) const {
+    if (i >= capacity) return capacity;
+
+    auto w = i / 64;
+    auto word = words[w] & (~uint64_t(0) << (i % 64));
+
+    while (word == 0) {
+      if (++w == W) return capacity;
+
+      word = words[w];
+    }
+
+    return 64 * w + __builtin_ctzll(word);
+  }
+
+  /**
+    @brief Return the first index in the set, or \e capacity if it's empty
+  */
+  inline size_t first() const { return next(0); }
+
+  /**
+    @brief Check if every index in the set is also in \e b
+  */
+  inline bool is_subset_of(const BitSet& b) const {
+    for (size_t w = 0; w < W; ++w) {
+      if ((words[w] & ~b.words[w]) != 0) return false;
+    }
+
+    return true;
+  }
+
+  /**
+    @brief Check if the set and \e b have an index in common
+  */
+  inline bool intersects(const BitSet& b) const {
+    for (size_t w = 0; w < W; ++w) {
+      if ((words[w] & b.words[w]) != 0) return true;
+    }
+
+    return false;
+  }
+
+  inline BitSet operator&(const BitSet& b) const {
+    BitSet output;
+
+    for (size_t w = 0; w < W; ++w) {
+      output.words[w] = words[w] & b.words[w];
+    }
+
+    return output;
+  }
+
+  inline BitSet operator|(const BitSet& b) const {
+    BitSet output;
+
+    for (size_t w = 0; w < W; ++w) {
+      output.words[w] = words[w] | b.words[w];
+    }
+
+    return output;
+  }
+
+  /**
+    @brief Return the indexes of the set that are not in \e b
+  */
+  inline BitSet operator-(const BitSet& b) const {
+    BitSet output;
+
+    for (size_t w = 0; w < W; ++w) {
+      output.words[w] = words[w] & ~b.words[w];
+    }
+
+    return output;
+  }
+
+  inline BitSet& operator|=(const BitSet& b) {
+    for (size_t w = 0; w < W; ++w) {
+      words[w] |= b.words[w];
+    }
+
+    return *this;
+  }
+
+  inline bool operator==(const BitSet& b) const { return words == b.words; }
+
+  inline bool operator!=(const BitSet& b) const { return words != b.words; }
+
+  /**
+    @brief Check if the set is in the relation \e rel with \e s (see
+           SetRelation)
+  */
+  inline bool is_related(const SetRelation rel, const BitSet& s) const {
+    switch (rel) {
+      case SetRelation::intersects:
+        return intersects(s);
+      case SetRelation::superset:
+        return s.is_subset_of(*this);
+      case SetRelation::straddles:
+        return intersects(s) && !is_subset_of(s);
+      default:
+        return intersects(s) && !is_subset_of(s) && !s.is_subset_of(*this);
+    }
+  }
+
+  /**
+    @brief Return the words of the set
+  */
+  inline const uint64_t* data() const { return words.data(); }
+};
+
+/**
+  @brief Return the first index r >= \e first in \e select such that the set
+         \e rows[r] is in the relation \e rel with \e s, or the capacity of
+         the sets if there is none
+
+  The sets of 4 words or more are scanned with a single call to the kernel
+  find_row (see set_kernels).
+*/
+template <size_t W>
+inline size_t find_row(const SetRelation rel,
+                       const std::array<BitSet<W>, BitSet<W>::capacity>& rows,
+                       const BitSet<W>& select, const size_t first,
+                       const BitSet<W>& s) {
+  if (BitSet<W>::vectorized)
+    return set_kernels().find_row(rel, rows[0].data(), select.data(), first,
+                                  s.data(), W);
+
+  if (first >= BitSet<W>::capacity) return BitSet<W>::capacity;
+
+  // visit the selected rows a word of select at a time
+  auto w = first / 64;
+  auto word = select.words[w] & (~uint64_t(0) << (first % 64));
+
+  while (true) {
+    for (; word != 0; word &= word - 1) {
+      const auto r = 64 * w + __builtin_ctzll(word);
+
+      if (rows[r].is_related(rel, s)) return r;
+    }
+
+    if (++w == W) return BitSet<W>::capacity;
+
+    word = select.words[w];
+  }
+}
+
+/**
+  @brief Struct used to represent the signed characters realized on a
+         BitMatrix, in order
+
+  Each character is gained and lost at most once, so the steps fit in a fixed
+  array of 2 * 64 * W elements.
+*/
+template <size_t W>
+struct BitReduction {
+  std::array<uint16_t, 2 * BitSet<W>::capacity> steps{};  ///< Index of the
+                                                          ///< character of
+                                                          ///< each step
+  std::array<State, 2 * BitSet<W>::capacity> states{};    ///< State of the
+                                                          ///< character of
+                                                          ///< each step
+  size_t size = 0;  ///< Number of steps
+
+  BitSet<W> gained{};  ///< Characters realized as c+
+  BitSet<W> lost{};    ///< Characters realized as c-
+
+  /**
+    @brief Append the signed character (\e c, \e state)
+  */
+  inline void push(const size_t c, const State state) {
+    steps[size] = c;
+    states[size] = state;
+    size++;
+
+    if (state == State::gain)
+      gained.set(c);
+    else
+      lost.set(c);
+  }
+
+  /**
+    @brief Append the signed characters of \e r
+  */
+  inline void append(const BitReduction& r) {
+    for (size_t i = 0; i < r.size; ++i) {
+      push(r.steps[i], r.states[i]);
+    }
+  }
+};
+
+template <size_t W>
+class BitHasse;
+
+/**
+  @brief Red-black graph of at most 64 * W species and 64 * W characters, whose
+         edges are stored as sets of species (one set of black edges and one
+         of red edges for each character)
+
+  Species and characters are identified by their index in the vertex order of
+  the red-black graph the matrix is built from, which is also the order of
+  their names (see fits_bitmatrix).
+  A BitMatrix follows the same steps as the functions on red-black graphs
+  (realize, reduce, ...) without allocating memory on the heap: a copy of the
+  matrix, of a maximal reducible graph or of a Hasse diagram is a fixed array
+  of words on the stack.
+*/
+template <size_t W>
+class BitMatrix {
+ public:
+  typedef BitSet<W> Set;
+
+  static constexpr size_t capacity = Set::capacity;  ///< Maximum number of
+                                                     ///< species and
+                                                     ///< characters
+
+  Set species{};     ///< Species in the graph
+  Set characters{};  ///< Characters in the graph
+
+  std::array<Set, capacity> black{};  ///< Species connected to each character
+                                      ///< by a black edge
+  std::array<Set, capacity> red{};    ///< Species connected to each character
+                                      ///< by a red edge
+
+  /**
+    @brief Empty matrix constructor
+  */
+  BitMatrix() = default;
+
+  /**
+    @brief Build the matrix of the red-black graph \e g, which must fit in the
+           matrix (see fits_bitmatrix)
+
+    @param[in] g Red-black graph
+  */
+  explicit BitMatrix(const RBGraph& g);
+
+  /**
+    @brief Compute a successful reduction of \e g (see reduce) with a BitMatrix
+
+    @param[in] g Red-black graph, which must fit in a BitMatrix<W>
+
+    @return Realized characters (list of signed characters), that is a
+            c-reduction of \e g.
+            If the reduction was successful then the bool flag will be true.
+            When the flag is false, the returned list is empty
+  */
+  static std::pair<std::list<SignedCharacter>, bool> reduce(const RBGraph& g);
+
+  /**
+    @brief Check if the character \e c is active (connected only by red edges)
+  */
+  inline bool is_active(const size_t c) const { return black[c].none(); }
+
+  /**
+    @brief Check if the character \e c is inactive (connected only by black
+           edges)
+  */
+  inline bool is_inactive(const size_t c) const { return red[c].none(); }
+
+  /**
+    @brief Build the connected component that contains \e c_species and
+           \e c_characters
+
+    @param[in,out] c_species    Species of the component
+    @param[in,out] c_characters Characters of the component
+  */
+  void component(Set& c_species, Set& c_characters) const;
+
+  /**
+    @brief Remove the species and the characters without edges
+  */
+  void remove_singletons();
+
+  /**
+    @brief Check if the character \e c is free: it's active and connected to
+           all the species of its connected component
+  */
+  inline bool is_free(const size_t c) const {
+    return characters.test(c) && is_active(c) && red[c].any() &&
+           is_closed(red[c]);
+  }
+
+  /**
+    @brief Check if the character \e c is universal: it's inactive and
+           connected to all the species of its connected component
+  */
+  inline bool is_universal(const size_t c) const {
+    return characters.test(c) && is_inactive(c) && black[c].any() &&
+           is_closed(black[c]);
+  }
+
+  /**
+    @brief Realize the character \e c (+ or -), without realizing the free and
+           universal characters that come up afterwards (see realize_character)
+
+    @return True if the realization is feasible
+  */
+  bool realize_character(const size_t c, const State state);
+
+  /**
+    @brief Remove the singletons and realize the free and universal characters,
+           until there are none left (see simplify)
+
+    @param[in,out] output Realized characters
+  */
+  void simplify(BitReduction<W>& output);
+
+  /**
+    @brief Realize the character \e c (+ or -) and the free and universal
+           characters that come up afterwards (see realize)
+
+    @param[in,out] output Realized characters
+
+    @return True if the realization is feasible
+  */
+  bool realize(const size_t c, const State state, BitReduction<W>& output);
+
+  /**
+    @brief Realize the characters \e lsc (+) in order, skipping the ones
+           already realized in \e output (see realize)
+
+    @param[in,out] output Realized characters
+
+    @return True if the realizations are feasible
+  */
+  bool realize(const Set& lsc, BitReduction<W>& output);
+
+  /**
+    @brief Compute the maximal characters (see maximal_characters): the
+           inactive characters whose species aren't included in the species
+           of another inactive character, the first one of each set of species
+
+    @return Maximal characters
+  */
+  Set maximal_characters() const;
+
+  /**
+    @brief Build the maximal reducible graph of the matrix, induced by the
+           maximal characters \e cm and by the active characters (see
+           maximal_reducible_view)
+
+    @param[in] cm Maximal characters
+
+    @return Maximal reducible graph
+  */
+  BitMatrix maximal_reducible_graph(const Set& cm) const;
+
+  /**
+    @brief Check if the matrix contains a red Σ-graph (see has_red_sigmagraph)
+
+    @return True if the matrix contains a red Σ-graph
+  */
+  bool has_red_sigmagraph() const;
+
+  /**
+    @brief Compute a successful reduction of the matrix (see try_reduce)
+
+    @param[in,out] output Realized characters
+
+    @return True if the reduction was successful
+  */
+  bool reduce(BitReduction<W>& output);
+
+ private:
+  /**
+    @brief Check if the characters connected to the species \e s are connected
+           only to species in \e s, that is if \e s is the set of species of
+           its connected components
+
+    Takes time linear in the number of characters, while building the
+    connected components takes quadratic time.
+  */
+  bool is_closed(const Set& s) const;
+
+  /**
+    @brief Realize the first safe source of the Hasse diagram of the connected
+           matrix (see try_reduce)
+
+    @param[in,out] output Realized characters
+
+    @return True if the matrix has a safe source
+  */
+  bool reduce_step(BitReduction<W>& output);
+
+  /**
+    @brief Find the first safe source of the Hasse diagram \e hasse of the
+           maximal reducible graph \e gm of the matrix (see initial_states)
+
+    @return Index of the safe source, or \e hasse.size if there is none
+  */
+  size_t safe_source(const BitMatrix& gm, const BitHasse<W>& hasse) const;
+
+  /**
+    @brief Check if the realization of the characters of the source \e v of
+           \e hasse is feasible and doesn't induce a red Σ-graph in the matrix
+           (see realize_source)
+  */
+  bool realize_source(const size_t v, const BitHasse<W>& hasse) const;
+
+  /**
+    @brief Check if the vertex \e v of \e hasse is the first vertex of a safe
+           chain, realized on \e gm (see chain_enumerator::visit_source)
+  */
+  static bool safe_chain(const size_t v, const BitMatrix& gm,
+                         const BitReduction<W>& realized,
+                         const BitHasse<W>& hasse);
+};
+
+/**
+  @brief Hasse diagram of a maximal reducible graph stored in a BitMatrix (see
+         hasse_diagram)
+
+  The vertices are ordered as the ones of the diagram built by
+  lazy_hasse_diagram, and the out-edges of a vertex are computed when needed.
+*/
+template <size_t W>
+class BitHasse {
+ public:
+  typedef BitSet<W> Set;
+
+  std::array<Set, Set::capacity> species{};     ///< Species of each vertex
+  std::array<Set, Set::capacity> characters{};  ///< Characters of each vertex
+  size_t size = 0;                              ///< Number of vertices
+
+  /**
+    @brief Build the Hasse diagram of the maximal reducible graph \e gm
+
+    @param[in] gm Maximal reducible graph
+  */
+  explicit BitHasse(const BitMatrix<W>& gm);
+
+  /**
+    @brief Check if the vertex \e v is a source (see hasse_sources)
+  */
+  bool is_source(const size_t v) const;
+
+  /**
+    @brief Compute the targets of the out-edges of the vertex \e v: the
+           vertices whose characters are minimal strict supersets of the ones
+           of \e v (see expand_vertex)
+
+    @return Targets of the out-edges of \e v
+  */
+  Set covers(const size_t v) const;
+
+ private:
+  /**
+    @brief Check if \e a is a strict subset of \e b
+  */
+  static inline bool is_strict_subset(const Set& a, const Set& b) {
+    return a != b && a.is_subset_of(b);
+  }
+};
+
+//=============================================================================
+// Algorithm functions
+
+/**
+  @brief Check if \e g can be reduced with a BitMatrix
+
+  The graph must have at most 256 species and 256 characters, each character
+  connected only by black edges or only by red edges, its species must come
+  before its characters in vertex order, and the species (and the characters)
+  must be ordered by the number in their names, as the ones of a graph read by
+  read_graph.
+
+  @param[in] g Red-black graph
+
+  @return True if \e g fits in a BitMatrix
+*/
+bool fits_bitmatrix(const RBGraph& g);
+
+/**
+  @brief Compute a successful reduction of \e g with the smallest BitMatrix it
+         fits in (see fits_bitmatrix)
+
+  The reduction is the same computed by try_reduce with the standard safe
+  source selection, \e g is left untouched.
+
+  @param[in] g Red-black graph
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+std::pair<std::list<SignedCharacter>, bool> reduce_bitmatrix(const RBGraph& g);
+
+#endif  // BITMATRIX_HPP
@@ -1,383 +1,381 @@
 #include "functions.hpp"
 #include <boost/graph/connected_components.hpp>
-#include <boost/graph/depth_first_search.hpp>
+#include "bitmatrix.hpp"
+#include "parallel.hpp"
+#include "verifier.hpp"
 
 //=============================================================================
 // Auxiliary structs and classes
 
-initial_state_visitor::initial_state_visitor()
-    : m_safe_sources{}, m_sources{}, chain{}, source_v{}, last_v{} {}
+bool realization_cache::find(const std::string& g_fingerprint,
+                             const std::list<std::string>& characters,
+                             SourceRealization& realization) {
+  const auto k = key(g_fingerprint, characters);
 
-initial_state_visitor::initial_state_visitor(std::list<HDVertex>& safe_sources,
-                                             std::list<HDVertex>& sources)
-    : m_safe_sources{&safe_sources},
-      m_sources{&sources},
-      chain{},
-      source_v{},
-      last_v{} {
-  m_safe_sources->clear();
-  m_sources->clear();
-}
-
-void initial_state_visitor::initialize_vertex(const HDVertex v,
-                                              const HDGraph& hasse) const {}
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-void initial_state_visitor::start_vertex(const HDVertex v,
-                                         const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: start_vertex: [ ";
+  const auto it = m_map.find(k);
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
-    }
+  if (it == m_map.end()) {
+    m_misses++;
 
-    std::cout << "]" << std::endl;
+    return false;
   }
 
-  source_v = v;
+  m_hits++;
+  realization = it->second;
 
-  chain.clear();
+  return true;
 }
 
-void initial_state_visitor::discover_vertex(const HDVertex v,
-                                            const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: discover_vertex: [ ";
+void realization_cache::insert(const std::string& g_fingerprint,
+                               const std::list<std::string>& characters,
+                               const SourceRealization& realization) {
+  auto k = key(g_fingerprint, characters);
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
-    }
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    std::cout << "]" << std::endl;
-  }
+  if (m_map.size() >= max_size) m_map.clear();
 
-  last_v = v;
+  m_map.emplace(std::move(k), realization);
 }
 
-void initial_state_visitor::examine_edge(const HDEdge e, const HDGraph& hasse) {
-  HDVertex vs, vt;
-  std::tie(vs, vt) = incident(e, hasse);
+void realization_cache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: examine_edge: [ ";
-
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+  m_map.clear();
+  m_hits = 0;
+  m_misses = 0;
+}
 
-    std::cout << "] -";
+size_t realization_cache::hits() {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  return m_hits;
+}
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+size_t realization_cache::misses() {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    std::cout << "-> [ ";
+  return m_misses;
+}
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
-    }
+std::string realization_cache::key(const std::string& g_fingerprint,
+                                   const std::list<std::string>& characters) {
+  // the characters are realized in order, so their order is part of the key
+  std::string output(g_fingerprint);
+  output += "#";
 
-    std::cout << "]" << std::endl;
+  for (const auto& ci : characters) {
+    output += ci;
+    output += ",";
   }
 
-  // add edge to the chain
-  chain.push_back(e);
+  return output;
 }
 
-void initial_state_visitor::tree_edge(const HDEdge e,
-                                      const HDGraph& hasse) const {
-  if (logging::enabled) {
-    // verbosity enabled
-    HDVertex vs, vt;
-    std::tie(vs, vt) = incident(e, hasse);
+chain_enumerator::chain_enumerator()
+    : m_safe_sources{},
+      m_sources{},
+      m_chain{},
+      m_realized{},
+      m_done{false} {}
 
-    std::cout << "DFS: tree_edge: [ ";
+chain_enumerator::chain_enumerator(std::list<HDVertex>& safe_sources,
+                                   std::list<HDVertex>& sources)
+    : m_safe_sources{&safe_sources},
+      m_sources{&sources},
+      m_chain{},
+      m_realized{},
+      m_done{false} {
+  m_safe_sources->clear();
+  m_sources->clear();
+}
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+void chain_enumerator::visit(HDGraph& hasse) {
+  const stats::scoped_timer timer(stats::Phase::chains);
 
-    std::cout << "] -";
+  // sources of the diagram, in vertex order
+  const auto sources = hasse_sources(hasse);
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  if (parallel::threads > 1 && !logging::enabled && sources.size() > 1) {
+    // the out-edges of a lazy diagram can't be built by concurrent
+    // enumerators, build them first
+    expand_vertices(hasse);
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+    visit_parallel(sources, hasse);
 
-    std::cout << "-> [ ";
+    return;
+  }
+
+  for (auto v = sources.cbegin(); v != sources.cend() && !m_done; ++v) {
+    // for each source of the diagram
+    if (visit_source(*v, hasse))
+      perform_test(*v, realize_source(*v, hasse), hasse);
+  }
+}
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
+void chain_enumerator::visit_parallel(const std::vector<HDVertex>& sources,
+                                      HDGraph& hasse) {
+  const auto n = sources.size();
+
+  // safe[i] is true if sources[i] is the source of a safe chain,
+  // realizable[i] is true if the realization of sources[i] is feasible
+  // (char instead of bool: each task writes its own element)
+  std::vector<char> safe(n, false), realizable(n, false);
+
+  // the events traced by each task are written as a whole, after the ones
+  // that came before the tasks
+  if (trace::enabled) trace::flush();
+
+  // tasks [0, n) enumerate the chains of each source, each one with its own
+  // enumerator, tasks [n, 2n) test the realization of each source
+  get_thread_pool().run(2 * n, [&](const size_t i) {
+    if (i < n) {
+      chain_enumerator enumerator;
+      safe[i] = enumerator.visit_source(sources[i], hasse);
+    } else {
+      realizable[i - n] = realize_source(sources[i - n], hasse);
     }
 
-    std::cout << "]" << std::endl;
-  }
+    if (trace::enabled) trace::flush();
+  });
 
-  // ignore
+  // classify the sources in the same order as the sequential enumeration
+  for (size_t i = 0; i < n && !m_done; ++i) {
+    if (safe[i]) perform_test(sources[i], realizable[i], hasse);
+  }
 }
 
-void initial_state_visitor::back_edge(const HDEdge e,
-                                      const HDGraph& hasse) const {
-  if (logging::enabled) {
-    // verbosity enabled
-    HDVertex vs, vt;
-    std::tie(vs, vt) = incident(e, hasse);
+bool chain_enumerator::visit_source(const HDVertex source, HDGraph& hasse) {
+  if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
+    // uninitialized graph properties
+    return false;
 
-    std::cout << "DFS: back_edge: [ ";
+  const auto& gm = *orig_gm(hasse);
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+  trace::emit(trace::Event::chains_source, hasse[source].species);
 
-    std::cout << "] -";
+  m_chain.clear();
+  m_realized.clear();
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  expand_vertex(source, hasse);
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+  if (out_degree(source, hasse) == 0) {
+    // source is also a sink, the chain is empty (and safe)
+    trace::emit(trace::Event::empty_chain);
 
-    std::cout << "-> [ ";
+    return true;
+  }
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
-    }
+  // the chains of source are the root-to-leaf paths of a tree of prefixes:
+  // the characters of each prefix are realized once on a copy of gm, which is
+  // copied again only when the prefix is shared by more than one chain, and
+  // the red Σ-graph test is performed at the leaves
 
-    std::cout << "]" << std::endl;
-  }
+  // states[i] is gm after the realization of the characters of source and of
+  // the first i edges of the chain
+  std::vector<std::unique_ptr<RBGraph>> states;
+  // realized_size[i] is the number of signed characters in m_realized after
+  // the realization of the characters of source and of the first i edges of
+  // the chain
+  std::vector<size_t> realized_size;
 
-  // ignore
-}
+  std::list<SignedCharacter> source_lsc;
+  for (const auto& ci : hasse[source].characters) {
+    source_lsc.push_back({ci, State::gain});
+  }
 
-void initial_state_visitor::forward_or_cross_edge(const HDEdge e,
-                                                  const HDGraph& hasse) {
-  HDVertex vs, vt;
-  std::tie(vs, vt) = incident(e, hasse);
+  auto root = std::make_unique<RBGraph>();
+  copy_graph(gm, *root);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: forward_or_cross_edge: [ ";
+  if (!realize_prefix(source_lsc, *root))
+    // no chain of source is feasible
+    return false;
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+  states.push_back(std::move(root));
+  realized_size.push_back(m_realized.size());
 
-    std::cout << "] -";
+  // stack of the out-edges that are left to visit for each vertex in the path
+  // from source to the current vertex: the path itself (m_chain) is made of
+  // the edges that lead to each vertex in the stack but the first one
+  std::vector<std::pair<HDOutEdgeIter, HDOutEdgeIter>> stack;
+  stack.push_back(out_edges(source, hasse));
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  while (!stack.empty()) {
+    auto& top = stack.back();
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+    if (top.first == top.second) {
+      // every chain through the current vertex has been enumerated, backtrack
+      stack.pop_back();
+      states.pop_back();
+      realized_size.pop_back();
 
-    std::cout << "-> [ ";
+      if (!m_chain.empty()) m_chain.pop_back();
+      if (!realized_size.empty()) m_realized.resize(realized_size.back());
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
+      continue;
     }
 
-    std::cout << "]" << std::endl;
-  }
+    // extend the path with the next out-edge of the current vertex
+    const auto e = *top.first;
+    ++top.first;
 
-  if (out_degree(vt, hasse) > 1) {
-    // e is not the last edge in the chain (vt is not a sink in hasse),
-    // ignore it and keep going
-    return;
-  }
+    std::unique_ptr<RBGraph> state;
 
-  auto v_test = vt;
+    if (top.first != top.second) {
+      // the prefix is shared with the chains through the next out-edges:
+      // checkpoint its state
+      state = std::make_unique<RBGraph>();
+      copy_graph(*states.back(), *state);
+    } else {
+      // e is the last out-edge of the current vertex, its state can be reused
+      state = std::move(states.back());
+    }
 
-  while (out_degree(v_test, hasse) == 1) {
-    // e is not the last edge in the chain (vt is not a sink in hasse),
-    // but it may be needed for the chain to complete
+    m_chain.push_back(e);
 
-    HDOutEdgeIter oe;
-    std::tie(oe, std::ignore) = out_edges(v_test, hasse);
+    const auto vt = target(e, hasse);
 
-    // add outedge to the chain
-    chain.push_back(*oe);
+    if (!realize_prefix(hasse[e].signedcharacters, *state)) {
+      // no chain through e is feasible, skip them
+      m_chain.pop_back();
+      m_realized.resize(realized_size.back());
 
-    // update v_test to current vt
-    v_test = target(*oe, hasse);
-  }
+      continue;
+    }
 
-  perform_test(v_test, hasse);
-}
+    expand_vertex(vt, hasse);
 
-void initial_state_visitor::finish_vertex(const HDVertex v,
-                                          const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: finish_vertex: [ ";
+    if (out_degree(vt, hasse) > 0) {
+      // vt is not a sink, keep going
+      states.push_back(std::move(state));
+      realized_size.push_back(m_realized.size());
+      stack.push_back(out_edges(vt, hasse));
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
+      continue;
     }
 
-    std::cout << "]" << std::endl;
-  }
+    // vt is a sink, m_chain is a maximal chain
+    trace::emit(trace::Event::test_chain_gm, m_realized, *state);
 
-  // build list of vertices in chain
-  std::list<HDVertex> chain_v;
-  for (const auto& e : chain) {
-    chain_v.push_back(source(e, hasse));
-  }
+    // if the realization didn't induce a red Σ-graph, chain is a safe chain
+    const auto safe = !has_red_sigmagraph(*state);
 
-  bool v_in_chain =
-      (std::find(chain_v.cbegin(), chain_v.cend(), v) != chain_v.cend());
+    trace::emit(safe ? trace::Event::no_sigma_gm : trace::Event::sigma_gm);
 
-  if (out_degree(v, hasse) > 0 || v_in_chain || last_v != v) {
-    // v is not the last vertex in the chain
-    // (which means the visit is backtracking)
-    return;
+    if (safe)
+      // m_chain is a safe chain, ignore the rest of the chains of source
+      return true;
+
+    m_chain.pop_back();
+    m_realized.resize(realized_size.back());
   }
 
-  perform_test(v, hasse);
+  return false;
 }
 
-void initial_state_visitor::perform_test(const HDVertex v,
-                                         const HDGraph& hasse) {
-  if (m_safe_sources == nullptr || m_sources == nullptr)
-    // uninitialized sources lists
-    return;
+bool chain_enumerator::realize_prefix(const std::list<SignedCharacter>& lsc,
+                                      RBGraph& g) {
+  for (const auto& i : lsc) {
+    if (std::find(m_realized.cbegin(), m_realized.cend(), i) !=
+        m_realized.cend())
+      // the signed character i has already been realized in the chain
+      continue;
 
-  // source_v holds the source vertex of the chain
-  // chain holds the list of edges representing the chain
+    std::list<SignedCharacter> sc;
+    bool feasible;
+    std::tie(sc, feasible) = realize(i, g);
 
-  // check if source_v is already in m_safe_sources or m_sources
-  if ((!m_safe_sources->empty() && source_v == m_safe_sources->back()) ||
-      (!m_sources->empty() && source_v == m_sources->back())) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << std::endl
-                << "Chain detected, but its Source has already been processed"
-                << std::endl
-                << std::endl;
+    if (!feasible) {
+      trace::emit(trace::Event::not_feasible_gm);
+
+      return false;
     }
 
-    return;
+    m_realized.insert(m_realized.cend(), sc.cbegin(), sc.cend());
   }
 
-  // test if chain is a safe chain
-  if (!safe_chain(v, hasse))
-    // chain is not a safe chain
+  return true;
+}
+
+void chain_enumerator::perform_test(const HDVertex source,
+                                    const bool realizable,
+                                    const HDGraph& hasse) {
+  if (m_safe_sources == nullptr || m_sources == nullptr)
+    // uninitialized sources lists
     return;
 
-  if (!realize_source(source_v, hasse))
-    // source_v is not realizable
+  if (!realizable)
+    // source is not realizable
     return;
 
-  // test is source_v is a safe source (for test 1)
-  if (safe_source_test1(hasse)) {
-    // source_v is a safe source, return (don't add it to m_sources)
-    m_safe_sources->push_back(source_v);
+  // test is source is a safe source (for test 1)
+  if (safe_source_test1(source, hasse)) {
+    // source is a safe source, return (don't add it to m_sources)
+    m_safe_sources->push_back(source);
 
     if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
       // exponential algorithm or user interaction enabled
       // or safe source selection index is not 0
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << std::endl
-                  << "Source added to the list of safe sources" << std::endl
-                  << std::endl;
-      }
+      trace::emit(trace::Event::safe_added);
 
       return;
     }
 
-    throw InitialState();
+    // source is the first safe source found, terminate the enumeration
+    m_done = true;
+
+    return;
   }
 
   // test if the list of safe sources is empty
   if (!m_safe_sources->empty()) {
     // list of safe sources is not empty, return (don't add it to m_sources)
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << std::endl
-                << "Test 2 and 3 wouldn't be feasible: "
-                << "the list of safe sources is not empty" << std::endl
-                << std::endl;
-    }
+    trace::emit(trace::Event::tests_skipped);
 
     return;
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "Source added to the list of sources" << std::endl;
+  trace::emit(trace::Event::source_added);
 
-    if (!chain.empty()) std::cout << std::endl;
-  }
-
-  m_sources->push_back(source_v);
+  m_sources->push_back(source);
 }
 
-bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
+//=============================================================================
+// Algorithm functions
+
+bool safe_chain(const HDVertex source, const std::vector<HDEdge>& chain,
+                const HDGraph& hasse) {
   if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
     // uninitialized graph properties
     return false;
 
   const auto& gm = *orig_gm(hasse);
 
-  // chain holds the list of edges representing the chain
-
   // test if the chain is empty
   if (chain.empty()) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << std::endl << "Empty chain" << std::endl << std::endl;
-    }
+    trace::emit(trace::Event::empty_chain);
 
     return true;
   }
 
+  // the characters gained along a chain are disjoint (each edge adds the
+  // characters its target has and its source hasn't), so the c-reduction S(C)
+  // is the list of characters of source followed by the labels of each edge
   std::list<SignedCharacter> lsc;
 
-  for (const auto& c : hasse[source_v].characters) {
+  for (const auto& c : hasse[source].characters) {
     lsc.push_back({c, State::gain});
   }
 
   for (const auto& e : chain) {
     for (const auto& sc : hasse[e].signedcharacters) {
-      const auto check_sc_in_chain =
-          std::find(hasse[v].characters.cbegin(), hasse[v].characters.cend(),
-                    sc.character);
-
-      if (check_sc_in_chain == hasse[v].characters.cend())
-        // ignore wrong edge (other chain, old edge)
-        break;
-
-      const auto check_sc_in_lsc = std::find(lsc.cbegin(), lsc.cend(), sc);
-
-      if (check_sc_in_lsc != lsc.cend())
-        // remove previous signed character in lsc - it might be out of order
-        lsc.erase(check_sc_in_lsc);
-
       lsc.push_back(sc);
     }
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl << "Test chain: < ";
-
-    for (const auto& kk : lsc) {
-      std::cout << kk << " ";
-    }
-
-    std::cout << "> on a copy of graph Gm" << std::endl;
-  }
+  trace::emit(trace::Event::test_chain, lsc);
 
   // copy gm to gm_test
   RBGraph gm_test;
@@ -387,21 +385,10 @@ bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
   bool feasible;
   std::tie(std::ignore, feasible) = realize(lsc, gm_test);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "Gm (copy) after the realization of the chain" << std::endl
-              << "Adjacency lists:" << std::endl
-              << gm_test << std::endl
-              << std::endl;
-  }
+  trace::emit(trace::Event::chain_realized, gm_test);
 
   if (!feasible) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Realization not feasible for Gm (copy)" << std::endl
-                << std::endl;
-    }
+    trace::emit(trace::Event::not_feasible_gm);
 
     return false;
   }
@@ -409,38 +396,29 @@ bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
   // if the realization didn't induce a red Σ-graph, chain is a safe chain
   const auto output = !has_red_sigmagraph(gm_test);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    if (output)
-      std::cout << "No red Σ-graph in Gm (copy)" << std::endl << std::endl;
-    else
-      std::cout << "Found red Σ-graph in Gm (copy)" << std::endl << std::endl;
-  }
+  trace::emit(output ? trace::Event::no_sigma_gm : trace::Event::sigma_gm);
 
   return output;
 }
 
-bool initial_state_visitor::safe_source_test1(const HDGraph& hasse) {
+bool safe_source_test1(const HDVertex source, const HDGraph& hasse) {
   if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
     // uninitialized graph properties
     return false;
 
   const auto& gm = *orig_gm(hasse);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl << "Safe sources - test 1" << std::endl;
-  }
+  trace::emit(trace::Event::test1);
 
   // search for a species s+ in GRB|CM∪A that consists of C(s) and is connected
   // to only inactive characters
-  for (const auto& species_name : hasse[source_v].species) {
+  for (const auto& species_name : hasse[source].species) {
     const auto source_s = get_vertex(species_name, gm);
-    // for each source species (s+) in source_v
+    // for each source species (s+) in source
     bool active = false;
 
     // check if s+ is connected to active characters
-    RBOutEdgeIter e, e_end;
+    RBViewOutEdgeIter e, e_end;
     std::tie(e, e_end) = out_edges(source_s, gm);
     for (; e != e_end; ++e) {
       // for each out egde from s+
@@ -456,106 +434,47 @@ bool initial_state_visitor::safe_source_test1(const HDGraph& hasse) {
       // s+ is connected to active characters
       continue;
 
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Source species: " << species_name << std::endl;
-    }
+    trace::emit(trace::Event::test1_species, species_name);
 
     return true;
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Safe sources - test 1 failed" << std::endl;
-  }
+  trace::emit(trace::Event::test1_failed);
 
   return false;
 }
 
-//=============================================================================
-// Algorithm functions
+std::list<HDVertex> initial_states(HDGraph& hasse) {
+  const stats::scoped_timer timer(stats::Phase::initial_states);
 
-std::list<HDVertex> initial_states(const HDGraph& hasse) {
   std::list<HDVertex> output;
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS visit on the Hasse diagram:" << std::endl << std::endl;
-  }
+  trace::emit(trace::Event::chains);
 
-  // the visitor continuosly modifies the sources variable (passed as reference)
-  // in search of safe chains and sources. At the end of the visit, sources
-  // holds the list of sources of the Hasse diagram.
+  // the enumerator continuosly modifies the sources variable (passed as
+  // reference) in search of safe chains and sources. At the end of the
+  // enumeration, sources holds the list of sources of the Hasse diagram.
   std::list<HDVertex> sources;
-  initial_state_visitor vis(output, sources);
-
-  try {
-    depth_first_search(hasse, boost::visitor(vis));
-  } catch (const InitialState& e) {
-  }
+  chain_enumerator enumerator(output, sources);
+  enumerator.visit(hasse);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "DFS visit on the Hasse diagram terminated" << std::endl
-              << std::endl;
-  }
+  trace::emit(trace::Event::chains_end);
 
   if (output.empty() && sources.size() == 1) {
     const auto source = sources.front();
 
     if (realize_source(source, hasse)) output.push_back(sources.front());
   } else if (output.empty() && sources.size() > 1) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Sources: < ";
-
-      for (const auto& i : sources) {
-        std::cout << "[ ";
-
-        for (const auto& kk : hasse[i].species) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << "( ";
-
-        for (const auto& kk : hasse[i].characters) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << ") ] ";
-      }
-
-      std::cout << ">" << std::endl << std::endl;
-    }
+    trace::emit(trace::Event::sources, trace::Sources{sources, hasse});
 
     output = safe_source_test2(sources, hasse);
 
     if (output.empty()) output = safe_source_test3(sources, hasse);
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Safe sources: < ";
-
-    for (const auto& i : output) {
-      std::cout << "[ ";
-
-      for (const auto& kk : hasse[i].species) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << "( ";
-
-      for (const auto& kk : hasse[i].characters) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << ") ] ";
-    }
+  trace::emit(trace::Event::safe_sources, trace::Sources{output, hasse});
 
-    std::cout << ">" << std::endl << std::endl;
-  }
+  stats::count(stats::Counter::safe_sources, output.size());
 
   return output;
 }
@@ -569,16 +488,13 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
     return output;
 
   // const RBGraph& g = *orig_g(hasse);
-  const RBGraph& gm = *orig_gm(hasse);
+  const auto& gm = *orig_gm(hasse);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl << "Safe sources - test 2" << std::endl;
-  }
+  trace::emit(trace::Event::test2);
 
   // list of characters of GRB|CM∪A
   std::list<std::string> gm_c;
-  RBVertexIter v, v_end;
+  RBViewVertexIter v, v_end;
   std::tie(v, v_end) = vertices(gm);
   for (; v != v_end; ++v) {
     if (!is_character(*v, gm)) continue;
@@ -608,7 +524,7 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
       size_t count_maximal = 0;
       bool active = false;
 
-      RBOutEdgeIter e, e_end;
+      RBViewOutEdgeIter e, e_end;
       std::tie(e, e_end) = out_edges(*v, gm);
       for (; e != e_end; ++e) {
         // for each out egde from s+
@@ -647,11 +563,7 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
         // s+ doesn't have a set of other maximal characters
         continue;
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "Source species (+ other maximal characters): "
-                  << gm[*v].name << std::endl;
-      }
+      trace::emit(trace::Event::test2_species, gm[*v].name);
 
       output.push_back(source);
 
@@ -663,12 +575,7 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
     if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
       // exponential algorithm or user interaction enabled
       // or safe source selection index is not 0
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << std::endl
-                  << "Source added to the list of safe sources" << std::endl
-                  << std::endl;
-      }
+      trace::emit(trace::Event::safe_added);
 
       continue;
     }
@@ -676,11 +583,7 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
     return output;
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    if (output.empty())
-      std::cout << "Safe sources - test 2 failed" << std::endl;
-  }
+  if (output.empty()) trace::emit(trace::Event::test2_failed);
 
   return output;
 }
@@ -695,12 +598,9 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 
   const auto& gm = *orig_gm(hasse);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl << "Safe sources - test 3" << std::endl;
-  }
+  trace::emit(trace::Event::test3);
 
-  HDVertexIMap source_map;
+  HDVertexIMap source_map(scratch());
 
   // make sure every source is connected to active characters
   for (const auto& source : sources) {
@@ -713,7 +613,7 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
       size_t active_count = 0;
 
       // check if s+ is connected to active characters
-      RBOutEdgeIter e, e_end;
+      RBViewOutEdgeIter e, e_end;
       std::tie(e, e_end) = out_edges(source_s, gm);
       for (; e != e_end; ++e) {
         // for each out egde from s+
@@ -761,34 +661,15 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
   }
 
   for (const auto& source : maybe_output) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Source (+ active characters): [ ";
-
-      for (const auto& kk : hasse[source].species) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << "( ";
-
-      for (const auto& kk : hasse[source].characters) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << ") ]" << std::endl;
-    }
+    trace::emit(trace::Event::test3_source, hasse[source].species,
+                hasse[source].characters);
 
     output.push_back(source);
 
     if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
       // exponential algorithm or user interaction enabled
       // or safe source selection index is not 0
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << std::endl
-                  << "Source added to the list of safe sources" << std::endl
-                  << std::endl;
-      }
+      trace::emit(trace::Event::safe_added);
 
       continue;
     }
@@ -796,37 +677,37 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
     return output;
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    if (output.empty())
-      std::cout << "Safe sources - test 3 failed" << std::endl;
-  }
+  if (output.empty()) trace::emit(trace::Event::test3_failed);
 
   return output;
 }
 
 bool realize_source(const HDVertex source, const HDGraph& hasse) {
+  const stats::scoped_timer timer(stats::Phase::realize_source);
+
   if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
     // uninitialized graph properties
     return false;
 
   const auto& g = *orig_g(hasse);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Test source realization: [ ";
+  trace::emit(trace::Event::test_source, hasse[source].species,
+              hasse[source].characters);
 
-    for (const auto& kk : hasse[source].species) {
-      std::cout << kk << " ";
-    }
+  SourceRealization realization;
 
-    std::cout << "( ";
+  if (source_cache().find(orig_g_fingerprint(hasse), hasse[source].characters,
+                          realization)) {
+    trace::emit(trace::Event::cached);
 
-    for (const auto& kk : hasse[source].characters) {
-      std::cout << kk << " ";
-    }
+    if (!realization.feasible)
+      trace::emit(trace::Event::not_feasible_g);
+    else if (realization.red_sigmagraph)
+      trace::emit(trace::Event::sigma_g);
+    else
+      trace::emit(trace::Event::no_sigma_g);
 
-    std::cout << ") ] on a copy of graph G" << std::endl;
+    return realization.feasible && !realization.red_sigmagraph;
   }
 
   // copy g to g_test
@@ -842,38 +723,38 @@ bool realize_source(const HDVertex source, const HDGraph& hasse) {
   bool feasible;
   std::tie(std::ignore, feasible) = realize(source_lsc, g_test);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "G (copy) after the realization of the source" << std::endl
-              << "Adjacency lists:" << std::endl
-              << g_test << std::endl
-              << std::endl;
-  }
+  trace::emit(trace::Event::source_realized, g_test);
+
+  realization.feasible = feasible;
 
   if (!feasible) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Realization not feasible for G (copy)" << std::endl;
-    }
+    trace::emit(trace::Event::not_feasible_g);
+
+    source_cache().insert(orig_g_fingerprint(hasse), hasse[source].characters,
+                          realization);
 
     return false;
   }
 
   // if the realization didn't induce a red Σ-graph, source is a safe source
-  const auto output = !has_red_sigmagraph(g_test);
+  realization.red_sigmagraph = has_red_sigmagraph(g_test);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    if (output)
-      std::cout << "No red Σ-graph in G (copy)" << std::endl;
-    else
-      std::cout << "Found red Σ-graph in G (copy)" << std::endl;
-  }
+  source_cache().insert(orig_g_fingerprint(hasse), hasse[source].characters,
+                        realization);
+
+  const auto output = !realization.red_sigmagraph;
+
+  trace::emit(output ? trace::Event::no_sigma_g : trace::Event::sigma_g);
 
   return output;
 }
 
+realization_cache& source_cache() {
+  static realization_cache cache;
+
+  return cache;
+}
+
 bool is_partial(const std::list<SignedCharacter>& reduction) {
   std::list<std::string> gained_c{};
 
@@ -895,43 +776,114 @@ bool is_partial(const std::list<SignedCharacter>& reduction) {
   return false;
 }
 
+void start_search(const bool clear_cache) {
+  exponential::explored = 0;
+  exponential::depth = 0;
+
+  if (clear_cache) source_cache().clear();
+
+  if (exponential::time_limit > 0) {
+    const auto limit = std::chrono::duration<double>(exponential::time_limit);
+
+    exponential::deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(limit);
+  }
+}
+
+bool search_limit_reached() {
+  if (exponential::max_nodes > 0 &&
+      exponential::explored >= exponential::max_nodes)
+    // node limit reached
+    return true;
+
+  if (exponential::time_limit > 0 &&
+      std::chrono::steady_clock::now() >= exponential::deadline)
+    // deadline reached
+    return true;
+
+  return false;
+}
+
 //=============================================================================
 // Algorithm main functions
 
 std::list<SignedCharacter> reduce(RBGraph& g) {
   std::list<SignedCharacter> output;
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "Working on the red-black graph G" << std::endl
-              << "Adjacency lists:" << std::endl
-              << g << std::endl
-              << std::endl;
+  if (bitmatrix::enabled && !trace::enabled && !exponential::enabled &&
+      !interactive::enabled && nthsource::index == 0 && fits_bitmatrix(g)) {
+    // small matrix with the standard safe source selection: follow the same
+    // steps on a BitMatrix
+    const stats::scoped_timer timer(stats::Phase::bitmatrix);
+
+    bool success;
+    std::tie(output, success) = reduce_bitmatrix(g);
+
+    if (!success)
+      // the graph can't be reduced
+      throw NoReduction();
+
+    return output;
   }
 
-  // cleanup graph from dead vertices
-  // TODO: check if this is needed (realize already does this?)
-  remove_singletons(g);
+  ReduceStatus status;
+  std::tie(output, status) = try_reduce(g);
+
+  switch (status) {
+    case ReduceStatus::no_reduction:
+      // the graph can't be reduced
+      throw NoReduction();
+
+    case ReduceStatus::search_limit:
+      // the search stopped before finding a successful reduction
+      throw SearchLimit();
+
+    default:
+      break;
+  }
+
+  return output;
+}
+
+std::pair<std::list<SignedCharacter>, ReduceStatus> try_reduce(
+    RBGraph& g, const HDSnapshot& snapshot) {
+  const stats::scoped_depth depth;
+
+  std::list<SignedCharacter> output;
+
+  trace::emit(trace::Event::working, g);
+
+  // cleanup graph from dead vertices, realize free and universal characters
+  output = simplify(g);
+
+  if (!output.empty()) {
+    // return < free and universal characters, reduce(g) >
+    std::list<SignedCharacter> rest;
+    ReduceStatus status;
+    std::tie(rest, status) = try_reduce(g, snapshot);
+
+    if (status != ReduceStatus::success)
+      // g can't be reduced
+      return std::make_pair(std::list<SignedCharacter>(), status);
+
+    output.splice(output.cend(), rest);
+
+    return std::make_pair(output, ReduceStatus::success);
+  }
 
   if (is_empty(g)) {
     // if graph is empty
     // return the empty sequence
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "G empty" << std::endl << std::endl;
-    }
+    trace::emit(trace::Event::empty);
 
     // return < >
-    return output;
+    return std::make_pair(output, ReduceStatus::success);
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "G not empty" << std::endl;
-  }
+  trace::emit(trace::Event::not_empty);
 
-  RBVertexIMap i_map, c_map;
+  RBVertexIMap i_map(scratch()), c_map(scratch());
   RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
 
   // fill the vertex index map i_assocmap
@@ -942,118 +894,59 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
   }
 
   // get number of components and the components map
+  stats::count(stats::Counter::components);
   const size_t c_count = boost::connected_components(
       g, c_assocmap, boost::vertex_index_map(i_assocmap));
 
-  // realize free characters in the graph
-  // TODO: check if this is needed (realize already does this?)
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_free(*v, g, c_map)) {
-      // if v is free
-      // realize v-
-      // return < v-, reduce(g) >
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "G free character " << g[*v].name << std::endl;
-      }
-
-      std::list<SignedCharacter> lsc;
-      std::tie(lsc, std::ignore) = realize({g[*v].name, State::lose}, g);
-
-      output.splice(output.cend(), lsc);
-      output.splice(output.cend(), reduce(g));
-
-      // return < v-, reduce(g) >
-      return output;
-    }
-  }
-
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "G no free characters" << std::endl;
-  }
-
-  // realize universal characters in the graph
-  // TODO: check if this is needed (realize already does this?)
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_universal(*v, g, c_map)) {
-      // if v is universal
-      // realize v+
-      // return < v+, reduce(g) >
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "G universal character " << g[*v].name << std::endl;
-      }
-
-      std::list<SignedCharacter> lsc;
-      std::tie(lsc, std::ignore) = realize({g[*v].name, State::gain}, g);
-
-      output.splice(output.cend(), lsc);
-      output.splice(output.cend(), reduce(g));
-
-      // return < v+, reduce(g) >
-      return output;
-    }
-  }
-
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "G no universal characters" << std::endl;
-  }
-
   if (c_count > 1) {
     const auto components = connected_components(g, c_map, c_count);
     // if graph is not connected
     // build subgraphs (connected components) g1, g2, etc.
     // return < reduce(g1), reduce(g2), ... >
     for (const auto& component : components) {
-      output.splice(output.cend(), reduce(*component.get()));
+      std::list<SignedCharacter> rest;
+      ReduceStatus status;
+      std::tie(rest, status) = try_reduce(*component.get(), snapshot);
+
+      if (status != ReduceStatus::success)
+        // a component can't be reduced
+        return std::make_pair(std::list<SignedCharacter>(), status);
+
+      output.splice(output.cend(), rest);
     }
 
     // return < reduce(g1), reduce(g2), ... >
-    return output;
+    return std::make_pair(output, ReduceStatus::success);
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl;
-  }
+  trace::emit(trace::Event::newline);
+
+  // next = snapshot of g, updated from the one of the previous step
+  HDSnapshot next;
 
   // gm = Grb|Cm∪A, maximal reducible graph of g (Grb)
-  const auto gm = maximal_reducible_graph(g, true);
+  const auto gm = maximal_reducible_view(
+      g, maximal_characters(g, snapshot, next), true);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "Subgraph Gm of G induced by the maximal characters Cm"
-              << std::endl
-              << "Adjacency lists:" << std::endl
-              << gm << std::endl
-              << std::endl;
-  }
+  trace::emit(trace::Event::gm, gm);
+
+  // the edges of p are built on demand when the search stops at the first safe
+  // source, and the diagram isn't printed
+  const bool lazy = !exponential::enabled && !interactive::enabled &&
+                    nthsource::index == 0 && !trace::enabled;
 
   // p = Hasse diagram for gm (Grb|Cm∪A)
   HDGraph p;
-  hasse_diagram(p, g, gm);
+  hasse_diagram(p, g, gm, snapshot, next, lazy);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Hasse diagram for the subgraph Gm" << std::endl
-              << "Adjacency lists:" << std::endl
-              << p << std::endl
-              << std::endl;
-  }
+  trace::emit(trace::Event::hasse, p);
 
   // s = initial states
   std::list<HDVertex> s = initial_states(p);
 
   if (s.empty())
     // p has no safe source
-    throw NoReduction();
+    return std::make_pair(output, ReduceStatus::no_reduction);
 
   HDVertex source = 0;
   std::list<SignedCharacter> sc;
@@ -1062,28 +955,26 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
   if (exponential::enabled) {
     // exponential algorithm enabled
     std::list<std::list<SignedCharacter>> sources_output;
+    bool limit = false;
 
     for (const auto& source : s) {
       // for each safe source in s
-      RBGraph g_test;
-      copy_graph(g, g_test);
+      if (search_limit_reached()) {
+        // stop the search, keep the reductions found so far
+        trace::emit(trace::Event::search_limit);
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "Current safe source: [ ";
+        limit = true;
 
-        for (const auto& kk : p[source].species) {
-          std::cout << kk << " ";
-        }
+        break;
+      }
 
-        std::cout << "( ";
+      exponential::explored++;
 
-        for (const auto& kk : p[source].characters) {
-          std::cout << kk << " ";
-        }
+      RBGraph g_test;
+      copy_graph(g, g_test);
 
-        std::cout << ") ]" << std::endl << std::endl;
-      }
+      trace::emit(trace::Event::current_source, p[source].species,
+                  p[source].characters);
 
       // realize the characters of the safe source
       sc.clear();
@@ -1092,89 +983,80 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
         sc.push_back({ci, State::gain});
       }
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "Realize the characters < ";
-
-        for (const auto& kk : sc) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << "> in G" << std::endl;
-      }
+      trace::emit(trace::Event::realize, sc);
 
       std::tie(sc, std::ignore) = realize(sc, g_test);
 
-      try {
-        std::list<SignedCharacter> rest = reduce(g_test);
+      std::list<SignedCharacter> rest;
+      ReduceStatus status;
 
-        if (logging::enabled) {
-          // verbosity enabled
-          std::cout << "Ok for safe source [ ";
+      exponential::depth++;
+      std::tie(rest, status) = try_reduce(g_test, next);
+      exponential::depth--;
 
-          for (const auto& kk : p[source].species) {
-            std::cout << kk << " ";
-          }
+      if (status == ReduceStatus::search_limit) {
+        // the search stopped while exploring the source
+        limit = true;
 
-          std::cout << "( ";
-
-          for (const auto& kk : p[source].characters) {
-            std::cout << kk << " ";
-          }
+        break;
+      }
 
-          std::cout << ") ]" << std::endl << std::endl;
-        }
+      if (status == ReduceStatus::success) {
+        trace::emit(trace::Event::ok_source, p[source].species,
+                    p[source].characters);
 
         // append the recursive call to the current source's output
         sc.splice(sc.end(), rest);
-        sources_output.push_back(sc);
-      } catch (const NoReduction& e) {
-        if (logging::enabled) {
-          // verbosity enabled
-          std::cout << "No for safe source [ ";
 
-          for (const auto& kk : p[source].species) {
-            std::cout << kk << " ";
-          }
+        if (exponential::stream && exponential::depth == 0) {
+          // print the reduction instead of storing it (only the first one is
+          // kept, as it is the return value)
+          if (!is_partial(sc)) {
+            std::cout << "Complete: < ";
 
-          std::cout << "( ";
+            for (const auto& kk : sc) {
+              std::cout << kk << " ";
+            }
 
-          for (const auto& kk : p[source].characters) {
-            std::cout << kk << " ";
+            std::cout << ">" << std::endl;
           }
 
-          std::cout << ") ]" << std::endl << std::endl;
+          if (sources_output.empty()) sources_output.push_back(sc);
+        } else {
+          sources_output.push_back(sc);
         }
+
+        if (exponential::first)
+          // first successful reduction found, stop the search
+          break;
+      } else {
+        trace::emit(trace::Event::no_source, p[source].species,
+                    p[source].characters);
       }
     }
 
+    if (sources_output.empty() && limit)
+      // the search stopped before finding a successful reduction
+      return std::make_pair(output, ReduceStatus::search_limit);
+
     if (sources_output.empty())
       // no realization induces a successful reduction
-      throw NoReduction();
+      return std::make_pair(output, ReduceStatus::no_reduction);
 
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Reductions: [" << std::endl;
+    if (trace::enabled) {
+      // trace enabled
+      trace::emit(trace::Event::reductions);
 
       for (const auto& lkk : sources_output) {
-        if (is_partial(lkk))
-          std::cout << "  Partial: ";
-        else
-          std::cout << "  Complete: ";
-
-        std::cout << "< ";
-
-        for (const auto& kk : lkk) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << ">" << std::endl;
+        trace::emit(is_partial(lkk) ? trace::Event::partial
+                                    : trace::Event::complete,
+                    lkk);
       }
 
-      std::cout << "]" << std::endl << std::endl;
+      trace::emit(trace::Event::reductions_end);
     }
 
-    return sources_output.front();
+    return std::make_pair(sources_output.front(), ReduceStatus::success);
   }
   // user-input-driven safe source selection
   else if (s.size() > 1 && interactive::enabled) {
@@ -1262,34 +1144,15 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
       sc.push_back({ci, State::gain});
     }
 
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "========================================"
-                << "========================================" << std::endl
-                << std::endl;
-    }
+    trace::emit(trace::Event::separator);
   } else if (s.size() > 1 && nthsource::index > 0) {
     if (nthsource::index < s.size())
       source = *std::next(s.cbegin(), nthsource::index);
     else
       source = s.back();
 
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Source [ ";
-
-      for (const auto& kk : p[source].species) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << "( ";
-
-      for (const auto& kk : p[source].characters) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << ") ] selected " << std::endl << std::endl;
-    }
+    trace::emit(trace::Event::selected, p[source].species,
+                p[source].characters);
   }
   // standard safe source selection (the first one found)
   else {
@@ -1302,16 +1165,7 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
     sc.push_back({ci, State::gain});
   }
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Realize the characters < ";
-
-    for (const auto& kk : sc) {
-      std::cout << kk << " ";
-    }
-
-    std::cout << "> in G" << std::endl;
-  }
+  trace::emit(trace::Event::realize, sc);
 
   // realize the characters of the safe source
   std::tie(sc, std::ignore) = realize(sc, g);
@@ -1320,9 +1174,85 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
   // output in constant time (std::list::splice simply moves pointers around
   // instead of copying the data)
   output.splice(output.cend(), sc);
-  output.splice(output.cend(), reduce(g));
+
+  std::list<SignedCharacter> rest;
+  ReduceStatus status;
+  std::tie(rest, status) = try_reduce(g, next);
+
+  if (status != ReduceStatus::success)
+    // g can't be reduced
+    return std::make_pair(std::list<SignedCharacter>(), status);
+
+  output.splice(output.cend(), rest);
 
   // return < sc, reduce(g) >
+  return std::make_pair(output, ReduceStatus::success);
+}
+
+std::list<SignedCharacter> expand_reduction(
+    const std::list<SignedCharacter>& reduction, const RBKernel& kernel) {
+  std::list<SignedCharacter> output;
+
+  for (const auto& sc : reduction) {
+    output.push_back(sc);
+
+    const auto in = kernel.characters.find(sc.character);
+
+    if (in == kernel.characters.cend()) continue;
+
+    // the duplicates of the character are realized right after it
+    for (const auto& ci : in->second) {
+      output.push_back({ci, sc.state});
+    }
+  }
+
+  return output;
+}
+
+std::list<SignedCharacter> reduce_matrix(RBGraph& g, const bool maximal,
+                                         const bool check,
+                                         const bool clear_cache) {
+  std::unique_ptr<reduction_checker> checker;
+
+  // the input matrix, before the algorithm changes g
+  if (check) checker.reset(new reduction_checker(g));
+
+  if (maximal) {
+    const auto gm = maximal_reducible_graph(g);
+
+    if (checker) {
+      // only the maximal characters are reduced
+      std::vector<size_t> keep_c;
+
+      RBVertexIter v, v_end;
+      std::tie(v, v_end) = vertices(gm);
+      for (; v != v_end; ++v) {
+        if (!is_character(*v, gm)) continue;
+
+        keep_c.push_back(std::stoul(gm[*v].name.substr(1)));
+      }
+
+      checker->keep_characters(keep_c);
+    }
+
+    g.clear();
+    copy_graph(gm, g);
+  }
+
+  RBKernel kernel{};
+
+  if (kernelization::enabled) kernel = kernelize(g);
+
+  start_search(clear_cache);
+
+  auto output = reduce(g);
+
+  if (kernelization::enabled) output = expand_reduction(output, kernel);
+
+  if (checker && !checker->check(output))
+    // the reduction can't be replayed on the input matrix
+    throw std::runtime_error("Reduction rejected by the check");
+
   return output;
 }
 
@@ -1330,6 +1260,18 @@ std::pair<std::list<SignedCharacter>, bool> realize(const SignedCharacter& sc,
                                                     RBGraph& g) {
   std::list<SignedCharacter> output;
 
+  if (!realize_character(sc, g)) return std::make_pair(output, false);
+
+  output.push_back(sc);
+
+  // delete all isolated vertices and realize all free and universal characters
+  // that came up after realizing sc
+  output.splice(output.cend(), simplify(g));
+
+  return std::make_pair(output, true);
+}
+
+bool realize_character(const SignedCharacter& sc, RBGraph& g) {
   // current character vertex
   RBVertex cv = 0;
 
@@ -1338,10 +1280,10 @@ std::pair<std::list<SignedCharacter>, bool> realize(const SignedCharacter& sc,
     cv = get_vertex(sc.character, g);
   } catch (const std::out_of_range& e) {
     // g has no vertex named sc.character
-    return std::make_pair(output, false);
+    return false;
   }
 
-  RBVertexIMap i_map, c_map;
+  RBVertexIMap i_map(scratch()), c_map(scratch());
   RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
 
   // fill vertex index map
@@ -1352,15 +1294,13 @@ std::pair<std::list<SignedCharacter>, bool> realize(const SignedCharacter& sc,
   }
 
   // build the components map
+  stats::count(stats::Counter::components);
   boost::connected_components(g, c_assocmap,
                               boost::vertex_index_map(i_assocmap));
 
   if (sc.state == State::gain && is_inactive(cv, g)) {
     // c+ and c is inactive
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Realizing " << sc;
-    }
+    trace::emit(trace::Event::realizing, sc);
 
     // realize the character c+:
     // - add a red edge between c and each species in D(c) \ N(c)
@@ -1381,90 +1321,93 @@ std::pair<std::list<SignedCharacter>, bool> realize(const SignedCharacter& sc,
         // there isn't an edge between *v and cv
         add_edge(*v, cv, Color::red, g);
     }
-
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << std::endl;
-    }
   } else if (sc.state == State::lose && is_active(cv, g)) {
     // c- and c is active
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Realizing " << sc << std::endl;
-    }
+    trace::emit(trace::Event::realizing, sc);
 
     // realize the character c-:
     // - delete all edges incident on c
     clear_vertex(cv, g);
   } else {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Could not realize " << sc << std::endl;
-    }
+    trace::emit(trace::Event::not_realized, sc);
 
     // this should never happen during the algorithm, but it is handled just in
     // case something breaks (or user input happens)
-    return std::make_pair(output, false);
+    return false;
   }
 
-  output.push_back(sc);
+  return true;
+}
+
+std::list<SignedCharacter> simplify(RBGraph& g) {
+  std::list<SignedCharacter> output;
 
   // delete all isolated vertices
   remove_singletons(g);
 
-  // fill vertex index map
-  std::tie(v, v_end) = vertices(g);
-  for (size_t index = 0; v != v_end; ++v, ++index) {
-    boost::put(i_assocmap, *v, index);
-  }
+  while (!is_empty(g)) {
+    RBVertexIMap i_map(scratch()), c_map(scratch());
+    RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
 
-  // build the components map
-  boost::connected_components(g, c_assocmap,
-                              boost::vertex_index_map(i_assocmap));
+    // fill vertex index map
+    RBVertexIter v, v_end;
+    std::tie(v, v_end) = vertices(g);
+    for (size_t index = 0; v != v_end; ++v, ++index) {
+      boost::put(i_assocmap, *v, index);
+    }
 
-  // realize all free characters that came up after realizing sc
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_free(*v, g, c_map)) {
-      // if v is free
-      // realize v-
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "G free character " << g[*v].name << std::endl;
-      }
+    // build the components map
+    stats::count(stats::Counter::components);
+    const size_t c_count = boost::connected_components(
+        g, c_assocmap, boost::vertex_index_map(i_assocmap));
 
-      std::list<SignedCharacter> lsc;
-      std::tie(lsc, std::ignore) = realize({g[*v].name, State::lose}, g);
+    const auto c_species = count_species(g, c_map, c_count);
 
-      output.splice(output.cend(), lsc);
+    // find the first free character, or else the first universal character
+    RBVertex free_char = 0, universal_char = 0;
+    bool free_found = false, universal_found = false;
 
-      return std::make_pair(output, true);
-    }
-  }
+    std::tie(v, v_end) = vertices(g);
+    for (; v != v_end; ++v) {
+      // for each vertex
+      if (is_free(*v, g, c_map, c_species)) {
+        free_char = *v;
+        free_found = true;
+        break;
+      }
 
-  // realize all universal characters that came up after realizing sc
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_universal(*v, g, c_map)) {
-      // if v is universal
-      // realize v+
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "G universal character " << g[*v].name << std::endl;
+      if (!universal_found && is_universal(*v, g, c_map, c_species)) {
+        universal_char = *v;
+        universal_found = true;
       }
+    }
+
+    SignedCharacter sc;
 
-      std::list<SignedCharacter> lsc;
-      std::tie(lsc, std::ignore) = realize({g[*v].name, State::gain}, g);
+    if (free_found) {
+      // realize the free character (-)
+      trace::emit(trace::Event::free, g[free_char].name);
 
-      output.splice(output.cend(), lsc);
+      sc = {g[free_char].name, State::lose};
+    } else if (universal_found) {
+      // realize the universal character (+)
+      trace::emit(trace::Event::universal, g[universal_char].name);
 
-      return std::make_pair(output, true);
+      sc = {g[universal_char].name, State::gain};
+    } else {
+      // no free or universal characters left
+      break;
     }
+
+    // free and universal characters can always be realized
+    realize_character(sc, g);
+    output.push_back(sc);
+
+    // delete all isolated vertices
+    remove_singletons(g);
   }
 
-  return std::make_pair(output, true);
+  return output;
 }
 
 std::pair<std::list<SignedCharacter>, bool> realize(const RBVertex v,
@@ -1487,6 +1430,8 @@ std::pair<std::list<SignedCharacter>, bool> realize(const RBVertex v,
 
 std::pair<std::list<SignedCharacter>, bool> realize(
     const std::list<SignedCharacter>& lsc, RBGraph& g) {
+  const stats::scoped_timer timer(stats::Phase::realize);
+
   std::list<SignedCharacter> output;
 
   // realize the list of signed characters lsc; the algorithm stops when a
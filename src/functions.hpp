@@ -1,186 +1,314 @@
 #ifndef FUNCTIONS_HPP
 #define FUNCTIONS_HPP
 
+#include <mutex>
+#include <unordered_map>
 #include "hdgraph.hpp"
 #include "rbgraph.hpp"
+#include "trace.hpp"
+
+//=============================================================================
+// Data structures
+
+/**
+  Scoped enumeration type used for the outcome of a reduction.
+
+  ReduceStatus is paired with the reduction returned by \e try_reduce.
+*/
+enum class ReduceStatus {
+  success,       ///< The graph has been reduced
+  no_reduction,  ///< The graph can't be reduced
+  search_limit   ///< The search exceeded its node or time limit
+};
 
 //=============================================================================
 // Auxiliary structs and classes
 
 /**
-  @brief Safe chain DFS Visitor exception
+  @brief Reduce exception
 
-  Thrown when \e initial_state_visitor finds a safe chain with a safe source
+  Thrown when \e reduce can't reduce the graph anymore
 */
-class InitialState : public std::exception {
+class NoReduction : public std::exception {
  public:
   /**
     @brief Returns the reason of the exception
 
     @return C String
   */
-  inline const char* what() const throw() { return "Found initial state"; }
+  inline const char* what() const throw() { return "Could not reduce graph"; }
 };
 
 /**
-  @brief Reduce exception
+  @brief Search limit exception
 
-  Thrown when \e reduce can't reduce the graph anymore
+  Thrown when \e reduce exceeds the node or time limit of the exponential
+  search before finding a successful reduction
 */
-class NoReduction : public std::exception {
+class SearchLimit : public std::exception {
  public:
   /**
     @brief Returns the reason of the exception
 
     @return C String
   */
-  inline const char* what() const throw() { return "Could not reduce graph"; }
+  inline const char* what() const throw() { return "Search limit reached"; }
 };
 
 /**
-  @brief DFS Visitor used in depth_first_search
+  @brief Struct used to represent the outcome of the realization of a source
+         on a copy of the red-black graph (see \e realize_source)
 */
-class initial_state_visitor : public boost::default_dfs_visitor {
+struct SourceRealization {
+  bool feasible{};        ///< The realization was feasible
+  bool red_sigmagraph{};  ///< The realization induced a red Σ-graph
+};
+
+/**
+  @brief Cache of the outcomes of the realizations of the sources
+
+  The same red-black graph, and the same sources, can be reached more than once
+  while reducing a graph (e.g. by different paths of the exponential search):
+  the outcome of the realization of a source only depends on the red-black
+  graph and on the characters of the source, so it is stored with the
+  fingerprint of the graph and the list of characters as key.
+  A change in the red-black graph changes its fingerprint, so the outcomes
+  stored for previous states of the graph are never returned for the current
+  one.
+
+  The cache can be accessed by more threads at the same time.
+*/
+class realization_cache {
  public:
   /**
-    @brief DFS Visitor default constructor
+    @brief Look up the outcome of the realization of \e characters on the graph
+           with fingerprint \e g_fingerprint
+
+    @param[in]  g_fingerprint Fingerprint of the red-black graph
+    @param[in]  characters    List of characters of the source
+    @param[out] realization   Stored outcome, if found
+
+    @return True if the outcome was found
   */
-  initial_state_visitor();
+  bool find(const std::string& g_fingerprint,
+            const std::list<std::string>& characters,
+            SourceRealization& realization);
 
   /**
-    @brief DFS Visitor constructor
+    @brief Store the outcome of the realization of \e characters on the graph
+           with fingerprint \e g_fingerprint
 
-    @param[out] safe_sources List of vertices representing the safe sources of
-                             the diagram
-    @param[out] sources      List of vertices representing the maybe-safe
-                             sources of the diagram
+    When the cache is full it is emptied before storing the outcome.
+
+    @param[in] g_fingerprint Fingerprint of the red-black graph
+    @param[in] characters    List of characters of the source
+    @param[in] realization   Outcome of the realization
   */
-  initial_state_visitor(std::list<HDVertex>& safe_sources,
-                        std::list<HDVertex>& sources);
+  void insert(const std::string& g_fingerprint,
+              const std::list<std::string>& characters,
+              const SourceRealization& realization);
 
   /**
-    @brief Invoked on every vertex of the graph before the start of the graph
-           search
-
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @brief Remove every stored outcome and reset the counters
   */
-  void initialize_vertex(const HDVertex v, const HDGraph& hasse) const;
+  void clear();
 
   /**
-    @brief Invoked on the source vertex once before the start of the search
+    @brief Return the number of successful look ups
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @return Number of hits
   */
-  void start_vertex(const HDVertex v, const HDGraph& hasse);
+  size_t hits();
 
   /**
-    @brief Invoked when a vertex is encountered for the first time
+    @brief Return the number of failed look ups
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @return Number of misses
   */
-  void discover_vertex(const HDVertex v, const HDGraph& hasse);
+  size_t misses();
+
+  static const size_t max_size = 1 << 16;  ///< Maximum number of outcomes
 
+ private:
   /**
-    @brief Invoked on every out-edge of each vertex after it is discovered
+    @brief Return the key used to store the outcome of the realization of
+           \e characters on the graph with fingerprint \e g_fingerprint
+
+    @param[in] g_fingerprint Fingerprint of the red-black graph
+    @param[in] characters    List of characters of the source
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @return Key
   */
-  void examine_edge(const HDEdge e, const HDGraph& hasse);
+  static std::string key(const std::string& g_fingerprint,
+                         const std::list<std::string>& characters);
 
-  /**
-    @brief Invoked on each edge as it becomes a member of the edges that form
-           the search tree
+  std::mutex m_mutex{};
+  std::unordered_map<std::string, SourceRealization> m_map{};
+  size_t m_hits{};
+  size_t m_misses{};
+};
+
+/**
+  @brief Enumerator of the maximal chains of a Hasse diagram
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+  A maximal chain is a path from a source to a sink of the diagram.
+  The enumerator visits the chains of each source depth-first, keeping on an
+  explicit stack the exact path from the source to the current vertex, so
+  that each maximal chain is enumerated once and tested as in \e safe_chain.
+*/
+class chain_enumerator {
+ public:
+  /**
+    @brief Chain enumerator default constructor
   */
-  void tree_edge(const HDEdge e, const HDGraph& hasse) const;
+  chain_enumerator();
 
   /**
-    @brief Invoked on the back edges in the graph
+    @brief Chain enumerator constructor
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @param[out] safe_sources List of vertices representing the safe sources of
+                             the diagram
+    @param[out] sources      List of vertices representing the maybe-safe
+                             sources of the diagram
   */
-  void back_edge(const HDEdge e, const HDGraph& hasse) const;
+  chain_enumerator(std::list<HDVertex>& safe_sources,
+                   std::list<HDVertex>& sources);
 
   /**
-    @brief Invoked on forward or cross edges in the graph
+    @brief Enumerate the maximal chains of each source of \e hasse
+
+    The enumeration stops at the first safe source, unless every safe source
+    is needed (exponential algorithm, user interaction or safe source
+    selection index).
+
+    With more than one thread (see \e parallel::threads) and logging disabled,
+    the chains and the realization of every source are tested in parallel,
+    then the sources are classified in the same order as the sequential
+    enumeration does.
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    The out-edges of a lazy diagram (see \e lazy_hasse_diagram) are built as
+    the chains reach their vertices, so a search that stops at the first safe
+    source only builds the part of the diagram it explores.
+
+    @param[in,out] hasse Hasse diagram graph
   */
-  void forward_or_cross_edge(const HDEdge e, const HDGraph& hasse);
+  void visit(HDGraph& hasse);
 
   /**
-    @brief Invoked on vertex \e v after finish_vertex has been called for all
-           the vertices in the DFS-tree rooted at vertex \e v
+    @brief Enumerate the maximal chains of \e source in \e hasse and test if
+           they are safe chains
+
+    The chains of \e source share their prefixes: the enumeration realizes
+    the characters of each edge once, on a copy of the maximal reducible graph
+    that is checkpointed only when the prefix is shared by more chains, and
+    tests for red Σ-graphs at the end of each chain (see \e safe_chain).
+    Total work is proportional to the number of edges in the tree of prefixes
+    instead of the sum of the lengths of the chains.
+
+    The enumeration stops at the first safe chain.
 
-    If vertex \e v is a leaf in the DFS-tree, then the finish_vertex function
-    is called on \e v after all the out-edges of \e v have been examined.
+    @param[in]     source Source vertex
+    @param[in,out] hasse  Hasse diagram graph (the out-edges of the vertices
+                          of the chains are built, see \e expand_vertex)
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @return True if \e source is the source of at least one safe chain
   */
-  void finish_vertex(const HDVertex v, const HDGraph& hasse);
+  bool visit_source(const HDVertex source, HDGraph& hasse);
 
   /**
-    @brief Test if \e chain is a safe chain with \e source_v as source
+    @brief Realize the list of characters \e lsc (+ or - each) in \e g,
+           ignoring the signed characters already realized in the chain
 
-    Call \e safe_chain to check if \e chain is a safe chain. If it is, run
-    Test 1 on \e source_v.
-    If Test 1 succeds, add \e source_v to the list of safe sources.
-    If Test 1 fails, add \e source_v to the list of sources (maybe safe).
+    @param[in]     lsc List of signed characters
+    @param[in,out] g   Red-black graph
 
-    @param[in] v     Current vertex
-    @param[in] hasse Hasse diagram graph
+    @return True if the realizations were feasible
   */
-  void perform_test(const HDVertex v, const HDGraph& hasse);
+  bool realize_prefix(const std::list<SignedCharacter>& lsc, RBGraph& g);
 
   /**
-    @brief Check if \e chain is a safe chain in \e hasse
+    @brief Test if \e source is a safe source, once a safe chain with
+           \e source as source has been found
 
-    Let GRB be a red-black graph, let P be the Hasse diagram for GRB|CM and let
-    C be a chain of P.
-    Then C is safe if the c-reduction S(C) of C is feasible for the graph and
-    applying S(C) to GRB results in a graph that has no red Σ-graphs.
+    If the realization of \e source is feasible, run Test 1 on \e source.
+    If Test 1 succeds, add \e source to the list of safe sources.
+    If Test 1 fails, add \e source to the list of sources (maybe safe).
 
-    @param[in] v     Current vertex
-    @param[in] hasse Hasse diagram graph
-
-    @return True if \e chain is a safe chain in \e hasse
+    @param[in] source     Source vertex
+    @param[in] realizable True if the realization of \e source is feasible
+                          (see \e realize_source)
+    @param[in] hasse      Hasse diagram graph
   */
-  bool safe_chain(const HDVertex v, const HDGraph& hasse);
+  void perform_test(const HDVertex source, const bool realizable,
+                    const HDGraph& hasse);
 
   /**
-    @brief Test if \e source_v satisfies the test 1 in \e hasse
-
-    Test 1:
-    A source s is safe for GRB if there exists a species s' in GRB|CM∪A that
-    consists of C(s), is connected to only inactive characters and the
-    realization of C(s') in GRB does not induce red Σ-graphs in GRB.
+    @brief Check if the enumeration can be terminated
 
-    @param[in] hasse Hasse diagram graph
+    The enumeration can be terminated once the first safe source has been found
+    (unless every safe source is needed).
 
-    @return True if \e source_v satisfies the test 1
+    @return True if the enumeration can be terminated
   */
-  bool safe_source_test1(const HDGraph& hasse);
+  inline bool done() const { return m_done; }
 
  private:
+  /**
+    @brief Test the chains and the realization of each source of \e hasse in
+           parallel, then classify the sources in order
+
+    @param[in] sources Sources of the diagram, in vertex order
+    @param[in] hasse   Hasse diagram graph (not lazy: the enumerators don't
+                       build out-edges concurrently)
+  */
+  void visit_parallel(const std::vector<HDVertex>& sources, HDGraph& hasse);
+
   std::list<HDVertex>* const m_safe_sources{};
   std::list<HDVertex>* const m_sources{};
-  std::list<HDEdge> chain{};
-  HDVertex source_v{};
-  HDVertex last_v{};
+  std::vector<HDEdge> m_chain{};
+  std::vector<SignedCharacter> m_realized{};
+  bool m_done{};
 };
 
 //=============================================================================
 // Algorithm functions
 
+/**
+  @brief Check if \e chain is a safe chain with \e source as source in
+         \e hasse
+
+  Let GRB be a red-black graph, let P be the Hasse diagram for GRB|CM and let
+  C be a chain of P.
+  Then C is safe if the c-reduction S(C) of C is feasible for the graph and
+  applying S(C) to GRB results in a graph that has no red Σ-graphs.
+
+  The chain is tested from scratch on a copy of GM; \e chain_enumerator tests
+  the chains of a source sharing the realization of their prefixes.
+
+  @param[in] source Source vertex
+  @param[in] chain  Edges of the chain, in order from \e source
+  @param[in] hasse  Hasse diagram graph
+
+  @return True if \e chain is a safe chain in \e hasse
+*/
+bool safe_chain(const HDVertex source, const std::vector<HDEdge>& chain,
+                const HDGraph& hasse);
+
+/**
+  @brief Test if \e source satisfies the test 1 in \e hasse
+
+  Test 1:
+  A source s is safe for GRB if there exists a species s' in GRB|CM∪A that
+  consists of C(s), is connected to only inactive characters and the
+  realization of C(s') in GRB does not induce red Σ-graphs in GRB.
+
+  @param[in] source Source vertex
+  @param[in] hasse  Hasse diagram graph
+
+  @return True if \e source satisfies the test 1
+*/
+bool safe_source_test1(const HDVertex source, const HDGraph& hasse);
+
 /**
   @brief Returns a list of safe sources
 
@@ -192,11 +320,11 @@ class initial_state_visitor : public boost::default_dfs_visitor {
   The source s of a safe chain C is the initial state of a tree T solving GRB
   if s is safe.
 
-  @param[in] hasse Hasse diagram graph
+  @param[in,out] hasse Hasse diagram graph (may be lazy, see \e visit)
 
   @return List of safe sources
 */
-std::list<HDVertex> initial_states(const HDGraph& hasse);
+std::list<HDVertex> initial_states(HDGraph& hasse);
 
 /**
   @brief Test if \e sources contain a source that satisfies the test 2 in
@@ -237,6 +365,9 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 /**
   @brief Check if the realization of \e source does not induce red Σ-graph
 
+  The outcome is looked up in (and stored into) the realization cache (see
+  \e source_cache).
+
   @param[in] source Source vertex
   @param[in] hasse  Hasse diagram graph
 
@@ -244,6 +375,13 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 */
 bool realize_source(const HDVertex source, const HDGraph& hasse);
 
+/**
+  @brief Return the cache of the outcomes of the realizations of the sources
+
+  @return Reference to the realization cache
+*/
+realization_cache& source_cache();
+
 /**
   @brief Check if \e reduction is not a complete c-reduction
 
@@ -253,6 +391,25 @@ bool realize_source(const HDVertex source, const HDGraph& hasse);
 */
 bool is_partial(const std::list<SignedCharacter>& reduction);
 
+/**
+  @brief Reset the node count and the deadline of the exponential search of
+         the calling thread, and empty the realization cache if \e clear_cache
+
+  Must be called before running \e reduce on a new instance. The outcomes in
+  the cache are valid for any instance, so they can be kept (e.g. by the
+  workers of ppp --daemon).
+
+  @param[in] clear_cache Empty the realization cache
+*/
+void start_search(const bool clear_cache = true);
+
+/**
+  @brief Check if the exponential search exceeded its node or time limit
+
+  @return True if the node limit or the deadline has been reached
+*/
+bool search_limit_reached();
+
 //=============================================================================
 // Algorithm main functions
 
@@ -267,6 +424,13 @@ bool is_partial(const std::list<SignedCharacter>& reduction);
   The extended c-reduction of R is the sequence of positive and negative
   characters obtained by the application of R to GRB.
 
+  When the exponential algorithm is enabled every safe source is tested, unless
+  \e exponential::first is set (the search stops at the first successful
+  reduction) or the search exceeds its node or time limit.
+
+  Throws NoReduction if \e g can't be reduced, SearchLimit if the exponential
+  search exceeds its limits before finding a successful reduction.
+
   @param[in,out] g Red-black graph
 
   @return Realized characters (list of signed characters), that is a
@@ -274,6 +438,67 @@ bool is_partial(const std::list<SignedCharacter>& reduction);
 */
 std::list<SignedCharacter> reduce(RBGraph& g);
 
+/**
+  @brief Compute an extended c-reduction that is a successful reduction of a
+         reducible graph, without throwing on failure
+
+  Same as \e reduce, but the outcome is returned along with the reduction
+  instead of being thrown. Used by the recursion of the algorithm, where
+  failing branches are common.
+  The maximal characters and the Hasse diagram of each step are updated from
+  the ones of the previous step (see \e HDSnapshot) instead of being built
+  from scratch, when possible.
+
+  @param[in,out] g        Red-black graph
+  @param[in]     snapshot Snapshot of the maximal characters and of the Hasse
+                          diagram of the previous step (invalid at the first
+                          step)
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the status will be
+          ReduceStatus::success.
+          When the status is not ReduceStatus::success, the returned list is
+          empty
+*/
+std::pair<std::list<SignedCharacter>, ReduceStatus> try_reduce(
+    RBGraph& g, const HDSnapshot& snapshot = HDSnapshot());
+
+/**
+  @brief Expand the c-reduction \e reduction of the kernel of a red-black graph
+         (see \e kernelize) to a c-reduction of the graph
+
+  Each signed character is followed by the same signed character for each
+  duplicate of the character.
+
+  @param[in] reduction C-reduction of the kernel
+  @param[in] kernel    Duplicates removed from the graph
+
+  @return C-reduction of the graph
+*/
+std::list<SignedCharacter> expand_reduction(
+    const std::list<SignedCharacter>& reduction, const RBKernel& kernel);
+
+/**
+  @brief Reduce the matrix in \e g as ppp does with each input file: its
+         maximal reducible graph if \e maximal, its kernel with
+         \e kernelization::enabled, and check the reduction on the matrix if
+         \e check
+
+  Throws NoReduction and SearchLimit like \e reduce, and std::runtime_error if
+  the reduction is rejected by the check.
+
+  @param[in,out] g           Red-black graph of the matrix
+  @param[in]     maximal     Reduce the maximal reducible graph of \e g
+  @param[in]     check       Check the reduction on the matrix
+  @param[in]     clear_cache Empty the realization cache (see start_search)
+
+  @return C-reduction of \e g
+*/
+std::list<SignedCharacter> reduce_matrix(RBGraph& g, const bool maximal,
+                                         const bool check,
+                                         const bool clear_cache = true);
+
 /**
   @brief Realize the character \e c (+ or -) in \e g
 
@@ -303,6 +528,33 @@ std::list<SignedCharacter> reduce(RBGraph& g);
 std::pair<std::list<SignedCharacter>, bool> realize(const SignedCharacter& sc,
                                                     RBGraph& g);
 
+/**
+  @brief Realize the character \e c (+ or -) in \e g, without realizing the
+         free and universal characters that come up afterwards
+
+  @param[in]     sc SignedCharacter of \e g
+  @param[in,out] g  Red-black graph
+
+  @return True if the realization of \e sc is feasible for \e g
+*/
+bool realize_character(const SignedCharacter& sc, RBGraph& g);
+
+/**
+  @brief Remove the singletons of \e g and realize its free and universal
+         characters, until there are none left
+
+  At each step the first free character of \e g (in vertex order) is realized,
+  or the first universal character if there are no free characters, which is
+  the order followed by reduce and realize.
+  Each step takes linear time: the connected components and the number of
+  species of each component are computed once, instead of once per character.
+
+  @param[in,out] g Red-black graph
+
+  @return Realized characters (list of signed characters)
+*/
+std::list<SignedCharacter> simplify(RBGraph& g);
+
 /**
   @brief Realize the inactive characters of the species \e v in \e g
 
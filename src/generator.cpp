@@ -0,0 +1,138 @@
+#include "generator.hpp"
+
+//=============================================================================
+// General functions
+
+BinaryMatrix random_matrix(const PhylogenyParameters& params,
+                           std::mt19937_64& rng) {
+  const auto n_chars = params.characters;
+  const auto n_nodes = std::max(2 * params.species, n_chars) + 1;
+
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  // parent of each node of the tree, node 0 is the root
+  std::vector<size_t> parent(n_nodes, 0);
+  for (size_t i = 2; i < n_nodes; ++i) {
+    if (coin(rng) < params.density)
+      parent[i] = i - 1;
+    else
+      parent[i] = rng() % i;
+  }
+
+  // characters gained in each node: the ones of node i are
+  // gains[first[i]], ..., gains[first[i + 1] - 1]
+  std::vector<size_t> node_of(n_chars), first(n_nodes + 1, 0), gains(n_chars);
+  for (auto& node : node_of) {
+    node = 1 + rng() % (n_nodes - 1);
+    first[node + 1]++;
+  }
+
+  for (size_t i = 1; i <= n_nodes; ++i) first[i] += first[i - 1];
+
+  {
+    auto next = first;
+    for (size_t c = 0; c < n_chars; ++c) gains[next[node_of[c]]++] = c;
+  }
+
+  // nodes other than the root, the first ones (after the shuffle) lose a
+  // character
+  std::vector<size_t> nodes(n_nodes - 1);
+  for (size_t i = 0; i < nodes.size(); ++i) nodes[i] = i + 1;
+
+  std::vector<uint8_t> loses(n_nodes, false);
+  for (size_t i = 0; i < std::min(params.losses, nodes.size()); ++i) {
+    std::swap(nodes[i], nodes[i + rng() % (nodes.size() - i)]);
+    loses[nodes[i]] = true;
+  }
+
+  // characters of each node, in order: the parent of a node comes before it
+  std::vector<uint8_t> states(n_nodes * n_chars, false);
+  std::vector<uint8_t> lost(n_chars, false);
+  std::vector<size_t> candidates;
+
+  for (size_t i = 1; i < n_nodes; ++i) {
+    const auto state = &states[i * n_chars];
+    const auto p_state = &states[parent[i] * n_chars];
+
+    std::copy(p_state, p_state + n_chars, state);
+
+    if (loses[i]) {
+      // lose one of the characters of the parent, if it wasn't lost yet
+      candidates.clear();
+
+      for (size_t c = 0; c < n_chars; ++c) {
+        if (p_state[c] && !lost[c]) candidates.push_back(c);
+      }
+
+      if (!candidates.empty()) {
+        const auto c = candidates[rng() % candidates.size()];
+        state[c] = false;
+        lost[c] = true;
+      }
+    }
+
+    for (auto j = first[i]; j < first[i + 1]; ++j) state[gains[j]] = true;
+  }
+
+  // the species are distinct random nodes
+  BinaryMatrix output;
+  output.species = std::min(params.species, nodes.size());
+  output.characters = n_chars;
+  output.cells.reserve(output.species * n_chars);
+
+  for (size_t i = 0; i < output.species; ++i) {
+    std::swap(nodes[i], nodes[i + rng() % (nodes.size() - i)]);
+
+    const auto state = &states[nodes[i] * n_chars];
+    output.cells.insert(output.cells.end(), state, state + n_chars);
+  }
+
+  return output;
+}
+
+void perturb(BinaryMatrix& m, const size_t flips, std::mt19937_64& rng) {
+  if (m.cells.empty()) return;
+
+  for (size_t i = 0; i < flips; ++i) {
+    auto& cell = m.cells[rng() % m.cells.size()];
+    cell = !cell;
+  }
+}
+
+void matrix_graph(const BinaryMatrix& m, RBGraph& g) {
+  std::vector<RBVertex> species(m.species), characters(m.characters);
+
+  for (size_t s = 0; s < m.species; ++s) {
+    species[s] = add_vertex("s" + std::to_string(s), Type::species, g);
+  }
+
+  for (size_t c = 0; c < m.characters; ++c) {
+    characters[c] = add_vertex("c" + std::to_string(c), Type::character, g);
+  }
+
+  for (size_t s = 0; s < m.species; ++s) {
+    for (size_t c = 0; c < m.characters; ++c) {
+      if (m.at(s, c)) add_edge(species[s], characters[c], g);
+    }
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const BinaryMatrix& m) {
+  os << m.species << " " << m.characters << std::endl << std::endl;
+
+  std::string row;
+
+  for (size_t s = 0; s < m.species; ++s) {
+    row.clear();
+
+    for (size_t c = 0; c < m.characters; ++c) {
+      if (c > 0) row += ' ';
+
+      row += m.at(s, c) ? '1' : '0';
+    }
+
+    os << row << '\n';
+  }
+
+  return os;
+}
@@ -0,0 +1,100 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "rbgraph.hpp"
+
+//=============================================================================
+// Data structures
+
+/**
+  @brief Binary matrix of species (rows) and characters (columns)
+*/
+struct BinaryMatrix {
+  size_t species{};              ///< Number of species
+  size_t characters{};           ///< Number of characters
+  std::vector<uint8_t> cells{};  ///< Cells, row by row
+
+  /**
+    @brief Return the cell of species \e s and character \e c
+  */
+  inline uint8_t& at(const size_t s, const size_t c) {
+    return cells[s * characters + c];
+  }
+
+  /**
+    @brief Return the cell of species \e s and character \e c
+  */
+  inline uint8_t at(const size_t s, const size_t c) const {
+    return cells[s * characters + c];
+  }
+};
+
+/**
+  @brief Parameters of a random persistent phylogeny (see random_matrix)
+*/
+struct PhylogenyParameters {
+  size_t species = 20;     ///< Number of species
+  size_t characters = 20;  ///< Number of characters
+  double density = 0.5;    ///< Probability that a node of the tree is a child
+                           ///< of the previous one rather than of a random
+                           ///< one: deeper trees give denser matrices
+  size_t losses = 0;       ///< Number of persistent losses (at most)
+};
+
+//=============================================================================
+// General functions
+
+/**
+  @brief Build a matrix that has a persistent phylogeny
+
+  The tree has 2 * species (or characters, if more) nodes besides the root,
+  each one a child of the previous node or of a random one (see
+  PhylogenyParameters::density). Each character is gained in a random node,
+  and \e losses random nodes lose one of the characters of their parent, each
+  character at most once: a node has the characters of its parent, plus the
+  ones it gains, minus the one it loses. The species are distinct random
+  nodes, so a few characters may have no species.
+
+  @param[in] params Parameters of the phylogeny
+  @param[in] rng    Random number generator
+
+  @return Matrix with a persistent phylogeny
+*/
+BinaryMatrix random_matrix(const PhylogenyParameters& params,
+                           std::mt19937_64& rng);
+
+/**
+  @brief Flip \e flips random cells of \e m (a cell can be flipped back)
+
+  @param[in] m     Matrix
+  @param[in] flips Number of flips
+  @param[in] rng   Random number generator
+*/
+void perturb(BinaryMatrix& m, const size_t flips, std::mt19937_64& rng);
+
+/**
+  @brief Build the red-black graph of \e m, as read_graph would from its file
+         (species s0, s1, ... then characters c0, c1, ...)
+
+  @param[in] m Matrix
+  @param[in] g Red-black graph, empty
+*/
+void matrix_graph(const BinaryMatrix& m, RBGraph& g);
+
+/**
+  @brief Print \e m in the format read by read_graph
+
+  @param[in] os Output stream
+  @param[in] m  Matrix
+
+  @return Output stream
+*/
+std::ostream& operator<<(std::ostream& os, const BinaryMatrix& m);
+
+#endif  // GENERATOR_HPP
@@ -3,13 +3,39 @@
 //=============================================================================
 // Output modifiers
 
+#ifndef NO_TRACE
 bool logging::enabled = false;
 
+bool trace::enabled = false;
+#endif
+
+bool stats::enabled = false;
+
 //=============================================================================
 // Algorithm modifiers
 
 bool exponential::enabled = false;
 
+bool exponential::first = false;
+
+bool exponential::stream = false;
+
+size_t exponential::max_nodes = 0;
+
+double exponential::time_limit = 0;
+
+thread_local size_t exponential::explored = 0;
+
+thread_local size_t exponential::depth = 0;
+
+thread_local std::chrono::steady_clock::time_point exponential::deadline{};
+
 bool interactive::enabled = false;
 
 size_t nthsource::index = 0;
+
+size_t parallel::threads = 1;
+
+bool kernelization::enabled = false;
+
+bool bitmatrix::enabled = true;
@@ -1,6 +1,7 @@
 #ifndef GLOBALS_HPP
 #define GLOBALS_HPP
 
+#include <chrono>
 #include <list>
 #include <string>
 
@@ -11,7 +12,29 @@
   @brief Global logging namespace
 */
 namespace logging {
+#ifndef NO_TRACE
 extern bool enabled;  ///< Logging toggle
+#else
+constexpr bool enabled = false;  ///< Logging compiled out (make notrace)
+#endif
+};
+
+/**
+  @brief Global event trace namespace
+*/
+namespace trace {
+#ifndef NO_TRACE
+extern bool enabled;  ///< Event trace toggle: -v, or --trace (see trace.hpp)
+#else
+constexpr bool enabled = false;  ///< Event trace compiled out (make notrace)
+#endif
+};
+
+/**
+  @brief Global statistics namespace
+*/
+namespace stats {
+extern bool enabled;  ///< Per-phase timers and counters toggle (see stats.hpp)
 };
 
 //=============================================================================
@@ -21,7 +44,18 @@ extern bool enabled;  ///< Logging toggle
   @brief Global exponential algorithm namespace
 */
 namespace exponential {
-extern bool enabled;  ///< Exponential algorithm toggle
+extern bool enabled;       ///< Exponential algorithm toggle
+extern bool first;         ///< Stop at the first successful reduction
+extern bool stream;        ///< Print successful reductions as they are found
+extern size_t max_nodes;   ///< Maximum number of explored nodes (0 = no limit)
+extern double time_limit;  ///< Time limit for each instance in seconds
+                           ///< (0 = no limit)
+
+// state of the search of each thread (see start_search)
+extern thread_local size_t explored;  ///< Number of explored nodes
+extern thread_local size_t depth;     ///< Current depth of the search
+extern thread_local std::chrono::steady_clock::time_point
+    deadline;  ///< Search deadline
 };
 
 /**
@@ -38,6 +72,28 @@ namespace nthsource {
 extern size_t index;  ///< Safe source index selection
 };
 
+/**
+  @brief Global parallel execution namespace
+*/
+namespace parallel {
+extern size_t threads;  ///< Number of threads (1 = sequential)
+};
+
+/**
+  @brief Global kernelization namespace
+*/
+namespace kernelization {
+extern bool enabled;  ///< Reduce the kernel of the matrix (see kernelize)
+};
+
+/**
+  @brief Global small-matrix engine namespace
+*/
+namespace bitmatrix {
+extern bool enabled;  ///< Reduce the matrices that fit in a BitMatrix with it
+                      ///< (see reduce_bitmatrix)
+};
+
 //=============================================================================
 // Typedefs used for readabily
 
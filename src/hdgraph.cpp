@@ -1,4 +1,5 @@
 #include "hdgraph.hpp"
+#include "trace.hpp"
 
 //=============================================================================
 // Boost functions (overloading)
@@ -97,9 +98,18 @@ bool is_included(const std::list<std::string>& a,
   return true;
 }
 
-void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
-  std::vector<std::list<RBVertex>> vec_adj_char(num_species(gm));
-  std::map<RBVertex, std::list<RBVertex>> adj_char;
+void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraphView& gm) {
+  // build the vertices, then the out-edges of each vertex
+  lazy_hasse_diagram(hasse, g, gm);
+  expand_vertices(hasse);
+}
+
+void lazy_hasse_diagram(HDGraph& hasse, const RBGraph& g,
+                        const RBGraphView& gm) {
+  boost::container::pmr::vector<boost::container::pmr::list<RBVertex>>
+      vec_adj_char(num_species(gm), scratch());
+  boost::container::pmr::map<RBVertex, boost::container::pmr::list<RBVertex>>
+      adj_char(scratch());
 
   // how vec_adj_char is going to be structured:
   // vec_adj_char[index] => < S, List of characters adjacent to S >
@@ -128,7 +138,7 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
   };
 
   // initialize vec_adj_char and adj_char for each species in the graph
-  RBVertexIter v, v_end;
+  RBViewVertexIter v, v_end;
   std::tie(v, v_end) = vertices(gm);
   for (size_t index = 0; v != v_end; ++v) {
     if (!is_species(*v, gm)) continue;
@@ -138,7 +148,7 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
     vec_adj_char[index].push_back(*v);
 
     // build v's set of adjacent characters
-    RBOutEdgeIter e, e_end;
+    RBViewOutEdgeIter e, e_end;
     std::tie(e, e_end) = out_edges(*v, gm);
     for (; e != e_end; ++e) {
       // ignore active characters
@@ -163,15 +173,20 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
     index++;
   }
 
-  auto compare_size = [](const std::list<RBVertex>& a,
-                         const std::list<RBVertex>& b) {
+  auto compare_size = [](const boost::container::pmr::list<RBVertex>& a,
+                         const boost::container::pmr::list<RBVertex>& b) {
     return a.size() < b.size();
   };
 
   // sort vec_adj_char by size in ascending order
-  std::sort(vec_adj_char.begin(), vec_adj_char.end(), compare_size);
+  std::stable_sort(vec_adj_char.begin(), vec_adj_char.end(), compare_size);
+
+  // vertex of each list of characters
+  std::map<std::list<std::string>, HDVertex> vertex_of;
+
+  auto& sets = hasse[boost::graph_bundle].sets;
+  sets.clear();
 
-  bool first_iteration = true;
   for (const auto& set : vec_adj_char) {
     // for each set of characters
     if (set.empty()) continue;
@@ -187,126 +202,607 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
 
     lcv.sort(compare_names);
 
-    if (first_iteration) {
-      // first iteration of the loop:
-      // add v to the Hasse diagram, and being the first vertex of the graph
-      // there's no need to do any work
-      add_vertex(gm[v].name, lcv, hasse);
+    const auto in = vertex_of.find(lcv);
 
-      first_iteration = false;
+    if (in != vertex_of.cend()) {
+      // there is a vertex with the same characters as v, add v to the list of
+      // species in it
+      hasse[in->second].species.push_back(gm[v].name);
 
       continue;
     }
 
-    // new_edges will contain the list of edges that may be added to the Hasse
-    // diagram: HDVertex is the source, std::string is the edge label
-    std::list<std::pair<HDVertex, std::string>> new_edges;
+    // build a vertex for v and add it to the Hasse diagram, its out-edges are
+    // built on demand
+    const auto u = add_vertex(gm[v].name, lcv, hasse);
+    hasse[u].expanded = false;
+
+    vertex_of.emplace(lcv, u);
+
+    sets.emplace_back(lcv.cbegin(), lcv.cend());
+    std::sort(sets.back().begin(), sets.back().end());
+  }
+
+  // Store the graph pointer into the Hasse diagram's graph properties
+  hasse[boost::graph_bundle].g = &g;
+  hasse[boost::graph_bundle].g_fingerprint = fingerprint(g);
+
+  // Store the maximal reducible graph pointer into the Hasse diagram's graph
+  // properties
+  hasse[boost::graph_bundle].gm = &gm;
+
+  hasse[boost::graph_bundle].lazy = true;
 
-    // check if there is a vertex with the same characters as v or if v needs
-    // to be added to the Hasse diagram
-    HDVertexIter hdv, hdv_end;
-    std::tie(hdv, hdv_end) = vertices(hasse);
-    for (; hdv != hdv_end; ++hdv) {
-      // for each vertex in hasse
+  // sort species names in each vertex
+  HDVertexIter u, u_end;
+  std::tie(u, u_end) = vertices(hasse);
+  for (; u != u_end; ++u) {
+    hasse[*u].species.sort(compare_names);
+  }
+}
 
-      if (lcv == hasse[*hdv].characters) {
-        // v and hdv have the same characters
+void expand_vertex(const HDVertex v, HDGraph& hasse) {
+  if (hasse[v].expanded) return;
 
-        // add v to the list of species in hdv
-        hasse[*hdv].species.push_back(gm[v].name);
+  auto is_subset = [](const std::vector<std::string>& a,
+                      const std::vector<std::string>& b) {
+    return a.size() < b.size() &&
+           std::includes(b.cbegin(), b.cend(), a.cbegin(), a.cend());
+  };
+
+  const auto& sets = hasse[boost::graph_bundle].sets;
+  const auto& v_set = sets[v];
+
+  // the vertices are sorted by number of characters, so the vertices whose
+  // characters strictly include the ones of v come after it, and each one
+  // comes after the vertices whose characters it includes: a vertex is
+  // minimal if it doesn't include the characters of an earlier minimal vertex
+  std::vector<HDVertex> covers;
+
+  for (auto u = v + 1; u < num_vertices(hasse); ++u) {
+    if (!is_subset(v_set, sets[u])) continue;
+
+    bool cover = true;
+
+    for (const auto& w : covers) {
+      if (is_subset(sets[w], sets[u])) {
+        cover = false;
 
         break;
       }
+    }
+
+    if (cover) covers.push_back(u);
+  }
+
+  for (const auto& u : covers) {
+    // label the edge with the characters gained from v to u
+    std::list<SignedCharacter> signedcharacters;
+
+    for (const auto& ci : hasse[u].characters) {
+      if (!std::binary_search(v_set.cbegin(), v_set.cend(), ci))
+        signedcharacters.push_back({ci, State::gain});
+    }
+
+    add_edge(v, u, signedcharacters, hasse);
+  }
+
+  hasse[v].expanded = true;
+}
+
+void expand_vertices(HDGraph& hasse) {
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    expand_vertex(*v, hasse);
+  }
+
+  hasse[boost::graph_bundle].lazy = false;
+  hasse[boost::graph_bundle].sets.clear();
+}
+
+std::vector<HDVertex> hasse_sources(const HDGraph& hasse) {
+  std::vector<HDVertex> output;
+
+  auto is_subset = [](const std::vector<std::string>& a,
+                      const std::vector<std::string>& b) {
+    return a.size() < b.size() &&
+           std::includes(b.cbegin(), b.cend(), a.cbegin(), a.cend());
+  };
+
+  const auto lazy = hasse[boost::graph_bundle].lazy;
+  const auto& sets = hasse[boost::graph_bundle].sets;
+
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    if (!lazy) {
+      if (in_degree(*v, hasse) == 0) output.push_back(*v);
+
+      continue;
+    }
+
+    // the vertices whose characters are included in the ones of v come
+    // before it
+    bool source = true;
+
+    for (HDVertex u = 0; u < *v && source; ++u) {
+      if (is_subset(sets[u], sets[*v])) source = false;
+    }
 
-      const std::list<std::string> lhdv = hasse[*hdv].characters;
+    if (source) output.push_back(*v);
+  }
+
+  return output;
+}
+
+const std::set<std::string>& maximal_characters(const RBGraph& g,
+                                                const HDSnapshot& prev,
+                                                HDSnapshot& next) {
+  const stats::scoped_timer timer(stats::Phase::maximal);
+
+  next = HDSnapshot();
+  next.valid = true;
+
+  // build the sets of species of the inactive characters of g
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (out_degree(*v, g) == 0 || !is_inactive(*v, g)) continue;
+    // for each inactive character
+
+    auto& ci_species = next.species_of[g[*v].name];
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      ci_species.push_back(g[target(*e, g)].name);
+    }
+
+    std::sort(ci_species.begin(), ci_species.end());
+
+    next.characters.push_back(g[*v].name);
+  }
+
+  // prev can be updated if the inactive characters of g are in prev, with the
+  // same sets of species
+  bool update = prev.valid;
+
+  for (const auto& ci : next.characters) {
+    if (!update) break;
+
+    const auto in = prev.species_of.find(ci);
+
+    if (in == prev.species_of.cend() || in->second != next.species_of[ci])
+      update = false;
+  }
+
+  auto is_included = [](const std::vector<std::string>& a,
+                        const std::vector<std::string>& b) {
+    return std::includes(b.cbegin(), b.cend(), a.cbegin(), a.cend());
+  };
 
-      // TODO: check if edge building is done right
+  if (update) {
+    // maximal characters of prev that are no longer in g, and sets of species
+    // of the ones left in g
+    std::list<std::string> removed;
+    std::set<std::vector<std::string>> kept;
+
+    for (const auto& ci : prev.cm) {
+      const auto in = next.species_of.find(ci);
+
+      if (in != next.species_of.cend())
+        kept.insert(in->second);
+      else
+        removed.push_back(ci);
+    }
+
+    // the sets of species of the maximal characters of prev left in g are
+    // still maximal, while the characters included in a removed maximal
+    // character may now be maximal: pool holds both (with the characters with
+    // the same species, as the vertex order may have changed), in vertex order
+    std::vector<std::string> pool;
+
+    for (const auto& ci : next.characters) {
+      if (kept.count(next.species_of[ci]) > 0) {
+        pool.push_back(ci);
+
+        continue;
+      }
 
-      // TODO: is_included might be superfluous
-      // initialize new_edges if lhdv is a subset of lcv, with the structure:
-      // *hdv -*ci-> v
-      if (is_included(lhdv, lcv)) {
-        // hdv is included in v
-        for (const auto& ci : lcv) {
-          // for each character in hdv
-          const auto in = std::find(lhdv.cbegin(), lhdv.cend(), ci);
+      for (const auto& ri : removed) {
+        if (is_included(next.species_of[ci], prev.species_of.at(ri))) {
+          pool.push_back(ci);
 
-          if (in == lhdv.end()) {
-            // character is not present in lhdv
-            new_edges.push_back(std::make_pair(*hdv, ci));
-          }
+          break;
         }
       }
+    }
 
-      // on the last iteration of the cycle, after having collected all the
-      // pairs in new_edges, add vertex and edges to the Hasse diagram
-      if (std::next(hdv) == hdv_end) {
-        // last iteration on the characters in the list has been performed
+    // keep the first character of each maximal set of species in the pool
+    for (auto ci = pool.cbegin(); ci != pool.cend(); ++ci) {
+      const auto& ci_species = next.species_of[*ci];
 
-        // build a vertex for v and add it to the Hasse diagram
-        const auto u = add_vertex(gm[v].name, lcv, hasse);
+      bool maximal = true;
 
-        // build in_edges for the vertex and add them to the Hasse diagram
-        for (const auto& ei : new_edges) {
-          // for each new edge to add to the Hasse diagram
-          HDEdge edge;
-          std::tie(edge, std::ignore) = add_edge(ei.first, u, hasse);
-          hasse[edge].signedcharacters.push_back({ei.second, State::gain});
-        }
+      for (auto di = pool.cbegin(); di != pool.cend() && maximal; ++di) {
+        if (di == ci) continue;
+
+        const auto& di_species = next.species_of[*di];
+
+        if (!is_included(ci_species, di_species)) continue;
+
+        // ci is not maximal if di is a superset or an earlier duplicate
+        if (ci_species.size() < di_species.size() || di < ci) maximal = false;
+      }
+
+      if (maximal) next.cm.insert(*ci);
+    }
+
+    next.updated = true;
+  } else {
+    for (const auto& ci : maximal_characters(g)) {
+      if (next.species_of.count(g[ci].name) == 0)
+        // ignore active characters
+        continue;
+
+      next.cm.insert(g[ci].name);
+    }
+  }
+
+  trace::emit(trace::Event::maximal, next.cm, next.cm.size());
+
+  return next.cm;
+}
+
+bool hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraphView& gm,
+                   const HDSnapshot& prev, HDSnapshot& next, const bool lazy) {
+  const stats::scoped_timer timer(stats::Phase::hasse);
+
+  auto compare_names = [](const std::string& a, const std::string& b) {
+    size_t a_index, b_index;
+    std::stringstream ss;
+
+    ss.str(a.substr(1));
+    ss >> a_index;
+
+    ss.clear();
+
+    ss.str(b.substr(1));
+    ss >> b_index;
+
+    return a_index < b_index;
+  };
+
+  auto is_subset = [](const std::vector<std::string>& a,
+                      const std::vector<std::string>& b) {
+    return a.size() < b.size() &&
+           std::includes(b.cbegin(), b.cend(), a.cbegin(), a.cend());
+  };
+
+  // vertex of the diagram
+  struct Entry {
+    std::vector<std::string> set{};    // sorted characters
+    std::list<std::string> species{};  // species
+    size_t first{};                    // position of the first species
+    size_t prev_index{};               // index of the vertex in prev
+    std::string lost{};                // maximal characters lost since prev
+    std::string gained{};              // maximal characters gained since prev
+    bool mapped{};                     // same species as the vertex in prev
+    bool changed{};                    // its edges have to be computed
+  };
+
+  std::vector<Entry> entries;
+
+  // let the shift of a species be the pair of the maximal characters it lost
+  // (A) and gained (B) since prev: for species with the same shift, the new
+  // sets S \ A ∪ B are ordered as the old sets S, so the edges of prev between
+  // vertices with the same shift are still edges of the diagram, unless a
+  // vertex with a different shift lies between them.
+  // If no other shift has the same A, no new edge can appear between them.
+  // The edges of a lazy diagram are not known, so it can't be updated.
+  bool update = next.updated && !prev.lazy;
+
+  if (update) {
+    std::map<std::string, std::vector<std::string>> set_of;
+    std::map<std::string, std::string> lost_of, gained_of;
+
+    // new maximal characters of each species
+    for (const auto& ci : next.cm) {
+      for (const auto& si : next.species_of.at(ci)) {
+        set_of[si].push_back(ci);
+      }
+
+      if (prev.cm.count(ci) > 0) continue;
+
+      for (const auto& si : next.species_of.at(ci)) {
+        gained_of[si] += ci + ",";
+      }
+    }
+
+    for (const auto& ci : prev.cm) {
+      if (next.cm.count(ci) > 0) continue;
+
+      for (const auto& si : prev.species_of.at(ci)) {
+        lost_of[si] += ci + ",";
+      }
+    }
+
+    // position of each species of gm, in vertex order: the diagram built from
+    // scratch adds the vertices sorted by size, then by this position
+    std::map<std::string, size_t> position;
+
+    RBViewVertexIter v, v_end;
+    std::tie(v, v_end) = vertices(gm);
+    for (size_t index = 0; v != v_end; ++v) {
+      if (is_species(*v, gm)) position[gm[*v].name] = index++;
+    }
+
+    // vertex of prev of each species
+    std::map<std::string, size_t> prev_of;
+
+    for (size_t i = 0; i < prev.species.size(); ++i) {
+      for (const auto& si : prev.species[i]) {
+        prev_of[si] = i;
+      }
+    }
+
+    // group the species by their maximal characters
+    std::map<std::vector<std::string>, size_t> entry_of;
+
+    for (const auto& kv : set_of) {
+      const auto pos = position.find(kv.first);
+
+      if (pos == position.cend()) {
+        // a species with maximal characters is not in gm
+        update = false;
 
         break;
       }
+
+      const auto in_prev = prev_of.find(kv.first);
+      const auto& lost = lost_of[kv.first];
+      const auto& gained = gained_of[kv.first];
+
+      auto found = entry_of.find(kv.second);
+
+      if (found == entry_of.cend()) {
+        Entry entry;
+        entry.set = kv.second;
+        entry.first = pos->second;
+        entry.lost = lost;
+        entry.gained = gained;
+        entry.mapped = (in_prev != prev_of.cend());
+        if (entry.mapped) entry.prev_index = in_prev->second;
+
+        std::tie(found, std::ignore) =
+            entry_of.emplace(kv.second, entries.size());
+        entries.push_back(std::move(entry));
+      }
+
+      auto& entry = entries[found->second];
+
+      entry.species.push_back(kv.first);
+      entry.first = std::min(entry.first, pos->second);
+
+      if (in_prev == prev_of.cend() || in_prev->second != entry.prev_index ||
+          lost != entry.lost || gained != entry.gained)
+        // the species of entry don't come from the same vertex of prev, or
+        // don't have the same shift
+        entry.mapped = false;
+    }
+
+    // shifts of the species of the diagram, for each A
+    std::map<std::string, std::set<std::string>> shifts;
+
+    for (const auto& kv : set_of) {
+      shifts[lost_of[kv.first]].insert(gained_of[kv.first]);
+    }
+
+    // count the mapped vertices with the same shift, when no other shift has
+    // the same A
+    std::map<std::pair<std::string, std::string>, size_t> count;
+
+    for (auto& entry : entries) {
+      if (entry.mapped &&
+          entry.species.size() != prev.species[entry.prev_index].size())
+        // part of the species of the vertex of prev are no longer in it
+        entry.mapped = false;
+
+      if (!entry.mapped || shifts[entry.lost].size() > 1) continue;
+
+      count[std::make_pair(entry.lost, entry.gained)]++;
+    }
+
+    // the edges of the vertices with the most common shift are kept, the
+    // edges of the other vertices are computed
+    std::pair<std::string, std::string> shift;
+    size_t max_count = 0;
+
+    for (const auto& kv : count) {
+      if (kv.second <= max_count) continue;
+
+      shift = kv.first;
+      max_count = kv.second;
     }
+
+    size_t n_changed = 0;
+
+    for (auto& entry : entries) {
+      entry.changed = !entry.mapped || entry.lost != shift.first ||
+                      entry.gained != shift.second;
+
+      if (entry.changed) n_changed++;
+    }
+
+    if (max_count == 0 || 2 * n_changed > entries.size())
+      // too many changed vertices, build the diagram from scratch
+      update = false;
   }
 
-  // Store the graph pointer into the Hasse diagram's graph properties
-  hasse[boost::graph_bundle].g = &g;
+  if (!update && lazy) {
+    // build the vertices of the diagram from scratch, its edges are not known
+    lazy_hasse_diagram(hasse, g, gm);
 
-  // Store the maximal reducible graph pointer into the Hasse diagram's graph
-  // properties
-  hasse[boost::graph_bundle].gm = &gm;
+    next.lazy = true;
 
-  // transitive reduction of the Hasse diagram
-  HDVertexIter u, u_end;
-  std::tie(u, u_end) = vertices(hasse);
-  for (; u != u_end; ++u) {
-    if (in_degree(*u, hasse) == 0 || out_degree(*u, hasse) == 0) continue;
-    // for each internal vertex in hasse
-
-    HDInEdgeIter ie, ie_end;
-    std::tie(ie, ie_end) = in_edges(*u, hasse);
-    for (; ie != ie_end; ++ie) {
-      // for each in-edge
-      HDOutEdgeIter oe, oe_end;
-      std::tie(oe, oe_end) = out_edges(*u, hasse);
-      for (; oe != oe_end; ++oe) {
-        // for each out-edge
-        // source -> u -> target
-        HDEdge e;
-        bool exists;
-        std::tie(e, exists) =
-            edge(source(*ie, hasse), target(*oe, hasse), hasse);
-
-        if (!exists)
-          // no transitivity between source and target
-          continue;
-
-        // remove source -> target, which breaks the no-transitivty rule in
-        // the Hasse diagram we need, because a path between source and target
-        // already exists in the form: source -> u -> target
-        remove_edge(e, hasse);
+    return false;
+  }
+
+  if (!update) {
+    // build the diagram from scratch and describe it in next
+    hasse_diagram(hasse, g, gm);
+
+    next.sets.clear();
+    next.species.clear();
+    next.edges.clear();
+
+    HDVertexIter u, u_end;
+    std::tie(u, u_end) = vertices(hasse);
+    for (; u != u_end; ++u) {
+      std::vector<std::string> set(hasse[*u].characters.cbegin(),
+                                   hasse[*u].characters.cend());
+      std::sort(set.begin(), set.end());
+
+      next.sets.push_back(std::move(set));
+      next.species.push_back(hasse[*u].species);
+
+      HDOutEdgeIter e, e_end;
+      std::tie(e, e_end) = out_edges(*u, hasse);
+      for (; e != e_end; ++e) {
+        next.edges.emplace_back(*u, target(*e, hasse));
       }
     }
+
+    return false;
   }
 
-  // sort species names in each vertex
-  std::tie(u, u_end) = vertices(hasse);
-  for (; u != u_end; ++u) {
-    auto species = hasse[*u].species;
+  // sort the vertices as the diagram built from scratch does
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              if (a.set.size() != b.set.size())
+                return a.set.size() < b.set.size();
+
+              return a.first < b.first;
+            });
+
+  // index of each kept vertex of prev in entries
+  std::map<size_t, size_t> index_of;
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i].changed) index_of[entries[i].prev_index] = i;
+  }
+
+  std::set<std::pair<size_t, size_t>> covers;
+
+  // the edges of prev between kept vertices are still edges, unless a changed
+  // vertex lies between them
+  for (const auto& ei : prev.edges) {
+    const auto u = index_of.find(ei.first);
+    const auto w = index_of.find(ei.second);
+
+    if (u == index_of.cend() || w == index_of.cend()) continue;
+
+    const auto& u_set = entries[u->second].set;
+    const auto& w_set = entries[w->second].set;
+
+    bool cover = true;
+
+    for (const auto& entry : entries) {
+      if (entry.changed && is_subset(u_set, entry.set) &&
+          is_subset(entry.set, w_set)) {
+        cover = false;
+
+        break;
+      }
+    }
+
+    if (cover) covers.emplace(u->second, w->second);
+  }
+
+  // the edges of a changed vertex go from the maximal vertices below it and to
+  // the minimal vertices above it
+  for (size_t t = 0; t < entries.size(); ++t) {
+    if (!entries[t].changed) continue;
+
+    const auto& t_set = entries[t].set;
+
+    std::vector<size_t> below, above;
+
+    for (size_t x = 0; x < entries.size(); ++x) {
+      if (is_subset(entries[x].set, t_set)) below.push_back(x);
+      if (is_subset(t_set, entries[x].set)) above.push_back(x);
+    }
+
+    for (const auto& x : below) {
+      bool cover = true;
 
-    species.sort(compare_names);
+      for (const auto& y : below) {
+        if (is_subset(entries[x].set, entries[y].set)) {
+          cover = false;
 
-    hasse[*u].species.clear();
-    hasse[*u].species.splice(hasse[*u].species.cend(), species);
+          break;
+        }
+      }
+
+      if (cover) covers.emplace(x, t);
+    }
+
+    for (const auto& x : above) {
+      bool cover = true;
+
+      for (const auto& y : above) {
+        if (is_subset(entries[y].set, entries[x].set)) {
+          cover = false;
+
+          break;
+        }
+      }
+
+      if (cover) covers.emplace(t, x);
+    }
+  }
+
+  // build the diagram and describe it in next
+  next.sets.clear();
+  next.species.clear();
+  next.edges.assign(covers.cbegin(), covers.cend());
+
+  size_t n_changed = 0;
+
+  for (auto& entry : entries) {
+    std::list<std::string> characters(entry.set.cbegin(), entry.set.cend());
+    characters.sort(compare_names);
+
+    entry.species.sort(compare_names);
+
+    add_vertex(entry.species, characters, hasse);
+
+    if (entry.changed) n_changed++;
+
+    next.sets.push_back(std::move(entry.set));
+    next.species.push_back(std::move(entry.species));
   }
+
+  for (const auto& ei : covers) {
+    // label the edge with the characters gained from source to target
+    std::list<SignedCharacter> signedcharacters;
+
+    for (const auto& ci : hasse[ei.second].characters) {
+      if (!std::binary_search(next.sets[ei.first].cbegin(),
+                              next.sets[ei.first].cend(), ci))
+        signedcharacters.push_back({ci, State::gain});
+    }
+
+    add_edge(ei.first, ei.second, signedcharacters, hasse);
+  }
+
+  // Store the graph pointers into the Hasse diagram's graph properties
+  hasse[boost::graph_bundle].g = &g;
+  hasse[boost::graph_bundle].g_fingerprint = fingerprint(g);
+  hasse[boost::graph_bundle].gm = &gm;
+
+  trace::emit(trace::Event::hasse_updated, n_changed, entries.size());
+
+  return true;
 }
@@ -1,7 +1,11 @@
 #ifndef HDGRAPH_HPP
 #define HDGRAPH_HPP
 
+#include <boost/container/pmr/vector.hpp>
 #include <boost/graph/graph_utility.hpp>
+#include <map>
+#include <set>
+#include <vector>
 #include "globals.hpp"
 #include "rbgraph.hpp"
 
@@ -59,14 +63,58 @@ struct HDEdgeProperties {
 struct HDVertexProperties {
   std::list<std::string> species{};  ///< List of species that label the vertex
   std::list<std::string> characters{};  ///< List of characters of the species
+
+  bool expanded = true;  ///< The out-edges of the vertex have been built (see
+                         ///< expand_vertex)
+};
+
+/**
+  @brief Struct used to represent the maximal characters and the Hasse diagram
+         of a red-black graph by name, so that they can be updated after the
+         graph has been reduced (see \e hasse_diagram)
+
+  Realizing a source only makes its characters active, so the sets of species
+  of the inactive characters that are left in the graph never change: the
+  species lose the removed maximal characters and may gain the characters that
+  become maximal, so most vertices of the diagram keep their species.
+*/
+struct HDSnapshot {
+  bool valid{};  ///< The snapshot describes a red-black graph
+
+  std::vector<std::string> characters{};  ///< Inactive characters, in vertex
+                                          ///< order
+  std::map<std::string, std::vector<std::string>>
+      species_of{};            ///< Sorted species of each inactive character
+  std::set<std::string> cm{};  ///< Maximal characters
+
+  bool updated{};  ///< The maximal characters have been updated from the ones
+                   ///< of the ancestor
+
+  std::vector<std::vector<std::string>> sets{};  ///< Sorted characters of each
+                                                 ///< vertex of the diagram
+  std::vector<std::list<std::string>> species{};  ///< Species of each vertex
+                                                  ///< of the diagram
+  std::vector<std::pair<size_t, size_t>> edges{};  ///< Edges of the diagram,
+                                                   ///< as pairs of indexes
+  bool lazy{};  ///< The edges of the diagram are not known (see
+                ///< lazy_hasse_diagram)
 };
 
 /**
   @brief Struct used to represent the properties of a Hasse diagram
 */
 struct HDGraphProperties {
-  const RBGraph* g{};   ///< Original red-black graph
-  const RBGraph* gm{};  ///< Original maximal reducible graph
+  const RBGraph* g{};       ///< Original red-black graph
+  const RBGraphView* gm{};  ///< Original maximal reducible graph (view of
+                            ///< the original red-black graph)
+
+  std::string g_fingerprint{};  ///< Fingerprint of the original red-black
+                                ///< graph when the diagram was built
+
+  bool lazy{};  ///< The out-edges of the vertices are built on demand (see
+                ///< expand_vertex)
+  std::vector<std::vector<std::string>> sets{};  ///< Sorted characters of each
+                                                 ///< vertex (lazy diagram)
 };
 
 //=============================================================================
@@ -130,9 +178,10 @@ typedef boost::graph_traits<HDGraph>::vertices_size_type HDVertexSize;
 // Maps
 
 /**
-  Map of vertex indexes (Hasse diagram)
+  Map of vertex indexes (Hasse diagram), built with scratch() when it's
+  transient
 */
-typedef std::map<HDVertex, HDVertexSize> HDVertexIMap;
+typedef boost::container::pmr::map<HDVertex, HDVertexSize> HDVertexIMap;
 
 /**
   Associative property map of vertex indexes (Hasse diagram)
@@ -250,10 +299,22 @@ inline const RBGraph* const orig_g(const HDGraph& hasse) {
 
   @return Pointer to the the original maximal reducible graph of \e hasse
 */
-inline const RBGraph* const orig_gm(const HDGraph& hasse) {
+inline const RBGraphView* const orig_gm(const HDGraph& hasse) {
   return hasse[boost::graph_bundle].gm;
 }
 
+/**
+  @brief Return the fingerprint of the original red-black graph of \e hasse,
+         as it was when \e hasse was built (see \e fingerprint)
+
+  @param[in] hasse Hasse diagram graph
+
+  @return Fingerprint of the original red-black graph of \e hasse
+*/
+inline const std::string& orig_g_fingerprint(const HDGraph& hasse) {
+  return hasse[boost::graph_bundle].g_fingerprint;
+}
+
 /**
   @brief Overloading of operator<< for HDGraph
 
@@ -292,8 +353,106 @@ bool is_included(const std::list<std::string>& a,
 
   @param[out] hasse Hasse diagram graph
   @param[in]  g     Red-black graph
-  @param[in]  gm    Maximal reducible red-black graph
+  @param[in]  gm    Maximal reducible red-black graph (view of \e g)
+*/
+void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraphView& gm);
+
+/**
+  @brief Build the vertices of the Hasse diagram of \e gm, leaving the edges
+         to be built on demand (lazy diagram)
+
+  The vertices are the same, in the same order, as the ones built by
+  \e hasse_diagram: they are sorted by number of characters, so the vertices
+  whose characters include the ones of a vertex come after it.
+  The out-edges of a vertex are built by \e expand_vertex, and the sources
+  of the diagram are found by \e hasse_sources without any edge.
+
+  @param[out] hasse Hasse diagram graph
+  @param[in]  g     Red-black graph
+  @param[in]  gm    Maximal reducible red-black graph (view of \e g)
+*/
+void lazy_hasse_diagram(HDGraph& hasse, const RBGraph& g,
+                        const RBGraphView& gm);
+
+/**
+  @brief Build the out-edges of \e v in \e hasse, if they haven't been built
+         yet
+
+  The out-edges of \e v go to the minimal vertices whose characters strictly
+  include the ones of \e v.
+
+  @param[in]     v     Vertex
+  @param[in,out] hasse Hasse diagram graph
+*/
+void expand_vertex(const HDVertex v, HDGraph& hasse);
+
+/**
+  @brief Build the out-edges of every vertex of \e hasse, so that the diagram
+         is no longer lazy
+
+  @param[in,out] hasse Hasse diagram graph
+*/
+void expand_vertices(HDGraph& hasse);
+
+/**
+  @brief Return the sources of \e hasse, in vertex order
+
+  In a lazy diagram a vertex is a source if no vertex has a strict subset of
+  its characters, otherwise if it has no in-edges.
+
+  @param[in] hasse Hasse diagram graph
+
+  @return Sources of \e hasse
+*/
+std::vector<HDVertex> hasse_sources(const HDGraph& hasse);
+
+/**
+  @brief Compute the names of the maximal characters of \e g, updating the
+         ones described by \e prev when possible
+
+  If \e prev describes an ancestor of \e g in the reduction (\e g has been
+  obtained by realizing characters, removing vertices or taking a connected
+  component), only the characters included in a removed maximal character can
+  become maximal: the others are not checked again.
+  Otherwise the maximal characters are computed from scratch.
+
+  @param[in]  g    Red-black graph
+  @param[in]  prev Snapshot of an ancestor of \e g (may be invalid)
+  @param[out] next Snapshot of \e g, without the Hasse diagram
+
+  @return Names of the maximal characters of \e g (in \e next)
+*/
+const std::set<std::string>& maximal_characters(const RBGraph& g,
+                                                const HDSnapshot& prev,
+                                                HDSnapshot& next);
+
+/**
+  @brief Build the Hasse diagram of \e gm, updating the one described by
+         \e prev when possible
+
+  If the maximal characters in \e next have been updated from \e prev (see
+  \e maximal_characters), the vertices of \e prev whose species all lost and
+  gained the same characters are kept, with their old edges (unless a changed
+  vertex lies between them); if at most half of the vertices change, only the
+  edges of the changed vertices are computed: the result is the same as the
+  one of \e hasse_diagram.
+  Otherwise the diagram is built from scratch. A lazy diagram doesn't describe
+  its edges in \e next, so the diagram that follows it is built from scratch
+  too.
+
+  @param[out]    hasse Hasse diagram graph
+  @param[in]     g     Red-black graph
+  @param[in]     gm    Maximal reducible red-black graph of \e g
+  @param[in]     prev  Snapshot of an ancestor of \e g (may be invalid)
+  @param[in,out] next  Snapshot of \e g, the diagram is added to it
+  @param[in]     lazy  Build a lazy diagram (see \e lazy_hasse_diagram)
+                       instead of building it from scratch
+
+  @return True if the diagram has been updated, false if it has been built
+          from scratch
 */
-void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm);
+bool hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraphView& gm,
+                   const HDSnapshot& prev, HDSnapshot& next,
+                   const bool lazy = false);
 
 #endif  // HDGRAPH_HPP
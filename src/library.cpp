@@ -0,0 +1,243 @@
+#include <condition_variable>
+#include <mutex>
+#include "bitmatrix.hpp"
+#include "functions.hpp"
+#include "generator.hpp"
+#include "ppp.hpp"
+
+namespace {
+
+/**
+  @brief Gate of the calls of solve: the options of the algorithm are global,
+         so the calls with the same options run at the same time, and a call
+         with different options waits for them to complete before setting its
+         own
+*/
+class options_gate {
+ public:
+  /**
+    @brief Wait until the global options can be \e options, and set them
+  */
+  void enter(const ppp::Options& options) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&] { return m_active == 0 || m_options == options; });
+
+    if (m_active++ > 0) return;
+
+    m_options = options;
+
+    exponential::enabled = options.exponential;
+    exponential::first = options.first;
+    exponential::max_nodes = options.max_nodes;
+    exponential::time_limit = options.timeout;
+    kernelization::enabled = options.kernel;
+    bitmatrix::enabled = options.bitmatrix;
+
+    // the thread pool can't be shared by the calls
+    parallel::threads = 1;
+  }
+
+  /**
+    @brief Let the calls with other options in
+  */
+  void leave() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (--m_active == 0) m_cv.notify_all();
+  }
+
+ private:
+  std::mutex m_mutex{};
+  std::condition_variable m_cv{};
+  ppp::Options m_options{};
+  size_t m_active{};
+};
+
+options_gate& gate() {
+  static options_gate instance;
+
+  return instance;
+}
+
+/**
+  @brief Reduce the matrix in \e cells with a BitMatrix<W>, which it must fit
+         in, as reduce_bitmatrix does with its red-black graph
+*/
+template <size_t W>
+ppp::Status reduce_cells(const uint8_t* cells, const size_t species,
+                         const size_t characters, const size_t stride,
+                         std::vector<ppp::Step>& reduction) {
+  BitMatrix<W> m;
+
+  for (size_t s = 0; s < species; ++s) {
+    m.species.set(s);
+  }
+
+  for (size_t c = 0; c < characters; ++c) {
+    m.characters.set(c);
+
+    for (size_t s = 0; s < species; ++s) {
+      if (cells[s * stride + c]) m.black[c].set(s);
+    }
+  }
+
+  BitReduction<W> output;
+
+  if (!m.reduce(output)) return ppp::Status::no_reduction;
+
+  for (size_t i = 0; i < output.size; ++i) {
+    reduction.push_back({output.steps[i], output.states[i] == State::gain});
+  }
+
+  return ppp::Status::success;
+}
+
+/**
+  @brief Reduce the matrix in \e cells as ppp does with each file
+*/
+ppp::Status reduce_graph(const uint8_t* cells, const size_t species,
+                         const size_t characters, const size_t stride,
+                         std::vector<ppp::Step>& reduction,
+                         const ppp::Options& options) {
+  // the arena of the thread is kept between the calls, so its pools are
+  // already filled after the first ones
+  thread_local scratch_arena arena;
+  scratch_scope scope(arena);
+
+  BinaryMatrix m;
+  m.species = species;
+  m.characters = characters;
+  m.cells.resize(species * characters);
+
+  for (size_t s = 0; s < species; ++s) {
+    for (size_t c = 0; c < characters; ++c) {
+      m.at(s, c) = cells[s * stride + c] != 0;
+    }
+  }
+
+  RBGraph g;
+  matrix_graph(m, g);
+
+  try {
+    const auto output =
+        reduce_matrix(g, options.maximal, options.check, false);
+
+    for (const auto& sc : output) {
+      reduction.push_back({static_cast<uint32_t>(
+                               std::stoul(sc.character.substr(1))),
+                           sc.state == State::gain});
+    }
+  } catch (const NoReduction& e) {
+    return ppp::Status::no_reduction;
+  } catch (const SearchLimit& e) {
+    return ppp::Status::search_limit;
+  }
+
+  return ppp::Status::success;
+}
+
+}  // namespace
+
+//=============================================================================
+// C++ interface
+
+ppp::Status ppp::solve(const uint8_t* cells, const size_t species,
+                       const size_t characters, const size_t stride,
+                       std::vector<Step>& reduction, const Options& options) {
+  reduction.clear();
+
+  if (cells == nullptr || species == 0 || characters == 0 ||
+      stride < characters)
+    return Status::invalid_argument;
+
+  if (options.bitmatrix && !options.exponential && !options.kernel &&
+      !options.maximal && !options.check &&
+      species <= BitMatrix<4>::capacity &&
+      characters <= BitMatrix<4>::capacity) {
+    // the bit-matrix engine doesn't read the global options
+    if (species <= BitMatrix<1>::capacity &&
+        characters <= BitMatrix<1>::capacity)
+      return reduce_cells<1>(cells, species, characters, stride, reduction);
+
+    if (species <= BitMatrix<2>::capacity &&
+        characters <= BitMatrix<2>::capacity)
+      return reduce_cells<2>(cells, species, characters, stride, reduction);
+
+    return reduce_cells<4>(cells, species, characters, stride, reduction);
+  }
+
+  gate().enter(options);
+
+  auto status = Status::error;
+
+  try {
+    status =
+        reduce_graph(cells, species, characters, stride, reduction, options);
+  } catch (const std::exception& e) {
+    // rejected by the check, or out of memory
+    reduction.clear();
+  }
+
+  gate().leave();
+
+  return status;
+}
+
+//=============================================================================
+// C interface
+
+int ppp_version(void) { return PPP_VERSION; }
+
+ppp_status ppp_solve(const uint8_t* cells, size_t species, size_t characters,
+                     size_t stride, const ppp_options* options,
+                     ppp_step* reduction, size_t capacity, size_t* length) {
+  // the buffer of the thread is kept between the calls
+  thread_local std::vector<ppp::Step> steps;
+
+  ppp::Options cpp_options;
+
+  if (options != nullptr) {
+    cpp_options.maximal = options->maximal;
+    cpp_options.check = options->check;
+    cpp_options.kernel = options->kernel;
+    cpp_options.exponential = options->exponential;
+    cpp_options.first = options->first;
+    cpp_options.max_nodes = options->max_nodes;
+    cpp_options.timeout = options->timeout;
+    cpp_options.bitmatrix = !options->no_bitmatrix;
+  }
+
+  if (length == nullptr || (reduction == nullptr && capacity > 0))
+    return PPP_INVALID_ARGUMENT;
+
+  const auto status =
+      ppp::solve(cells, species, characters, stride, steps, cpp_options);
+
+  *length = steps.size();
+
+  switch (status) {
+    case ppp::Status::success:
+      break;
+
+    case ppp::Status::no_reduction:
+      return PPP_NO_REDUCTION;
+
+    case ppp::Status::search_limit:
+      return PPP_SEARCH_LIMIT;
+
+    case ppp::Status::invalid_argument:
+      return PPP_INVALID_ARGUMENT;
+
+    default:
+      return PPP_ERROR;
+  }
+
+  if (steps.size() > capacity) return PPP_BUFFER_TOO_SMALL;
+
+  for (size_t i = 0; i < steps.size(); ++i) {
+    reduction[i].character = steps[i].character;
+    reduction[i].gain = steps[i].gain;
+  }
+
+  return PPP_SUCCESS;
+}
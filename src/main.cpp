@@ -1,6 +1,8 @@
 #include <boost/program_options.hpp>
-#include <boost/python.hpp>
+#include <unistd.h>
 #include "functions.hpp"
+#include "output.hpp"
+#include "server.hpp"
 
 void conflicting_options(const boost::program_options::variables_map& vm,
                          const std::string& opt1, const std::string& opt2) {
@@ -11,9 +13,67 @@ void conflicting_options(const boost::program_options::variables_map& vm,
   }
 }
 
+void option_dependency(const boost::program_options::variables_map& vm,
+                       const std::string& for_what,
+                       const std::string& required_option) {
+  if (vm.count(for_what) && !vm[for_what].defaulted()) {
+    if (vm.count(required_option) == 0 || vm[required_option].defaulted()) {
+      throw std::logic_error(std::string("option --") + for_what +
+                             " requires option --" + required_option);
+    }
+  }
+}
+
+/**
+  @brief Print the result of an input file as a line of text, after the
+         progress (or with the operations, with -v)
+*/
+void print_result(const output::Record& record) {
+  if (!logging::enabled) {
+    // verbosity disabled
+    std::cout << '\r';
+  }
+
+  switch (record.status) {
+    case output::Status::ok:
+      std::cout << "Ok (" << record.file << ")";
+      break;
+
+    case output::Status::unknown:
+      std::cout << "?? (" << record.file << ")";
+      break;
+
+    default:
+      std::cout << "No (" << record.file << ")";
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    if (record.status != output::Status::ok) {
+      std::cout << ": " << record.reason;
+    } else if (exponential::enabled) {
+      // exponential algorithm enabled
+      std::cout << ": Successful reductions have been logged";
+    } else {
+      std::cout << ": < ";
+
+      for (const auto& sc : record.reduction) {
+        std::cout << sc << " ";
+      }
+
+      std::cout << ">";
+    }
+  }
+
+  // flushed by stdout if it is a terminal, not for each file otherwise
+  std::cout << '\n';
+}
+
 int main(int argc, const char* argv[]) {
   // declare the vector of input files
   std::vector<std::string> files;
+  // format of the results
+  auto format = output::Format::text;
 
   // initialize options menu
   boost::program_options::options_description general_options(
@@ -27,19 +87,49 @@ int main(int argc, const char* argv[]) {
 
   general_options.add_options()
       // option: help message
-      ("help,h", "Display this message.\n")
+      ("help,h", "Display this message.\n");
+
+#ifndef NO_TRACE
+  general_options.add_options()
       // option: verbose, print information on the ongoing operations
       ("verbose,v", boost::program_options::bool_switch(&logging::enabled),
        "Display the operations performed by the program.\n")
-      // option: testpy, test reduce output with a python script
-      ("testpy,t", boost::program_options::bool_switch()->default_value(false),
-       "Test the output of the algorithm with check_reduction.py.\n")
+      // option: trace, write the operations to a binary trace file
+      ("trace", boost::program_options::value<std::string>(),
+       "Write the operations performed by the program to the binary trace "
+       "file FILE, printed by ppp-trace.\n");
+#endif
+
+  general_options.add_options()
+      // option: check, replay the reduce output on the input matrix
+      ("check,c", boost::program_options::bool_switch()->default_value(false),
+       "Check the output of the algorithm on the input matrix.\n")
       // option: exponential, test every possible combination of safe sources
       ("exponential,x",
        boost::program_options::bool_switch(&exponential::enabled),
        "Exponential version of the algorithm.\n"
        "(Mutually exclusive with --interactive)\n"
        "(Mutually exclusive with --nthsource)\n")
+      // option: first, stop the exponential search at the first reduction
+      ("first,f", boost::program_options::bool_switch(&exponential::first),
+       "Stop at the first successful reduction.\n"
+       "(Requires --exponential)\n")
+      // option: stream, print the successful reductions as they are found
+      ("stream,s", boost::program_options::bool_switch(&exponential::stream),
+       "Print the complete reductions as they are found.\n"
+       "(Requires --exponential)\n")
+      // option: max-nodes, limit the number of explored nodes
+      ("max-nodes",
+       boost::program_options::value<size_t>(&exponential::max_nodes)
+           ->default_value(0),
+       "Explore at most N safe sources for each file (0 = no limit).\n"
+       "(Requires --exponential)\n")
+      // option: timeout, limit the search time
+      ("timeout",
+       boost::program_options::value<double>(&exponential::time_limit)
+           ->default_value(0),
+       "Stop the search after N seconds for each file (0 = no limit).\n"
+       "(Requires --exponential)\n")
       // option: interactive, let the user select which path to take
       ("interactive,i",
        boost::program_options::bool_switch(&interactive::enabled),
@@ -55,8 +145,50 @@ int main(int argc, const char* argv[]) {
            ->default_value(0),
        "Select the nth safe source when possible.\n"
        "(Mutually exclusive with --exponential)\n"
+       "(Mutually exclusive with --interactive)\n")
+      // option: threads, test the sources of the Hasse diagram in parallel
+      ("threads",
+       boost::program_options::value<size_t>(&parallel::threads)
+           ->default_value(1),
+       "Test the sources of the Hasse diagrams with N threads.\n"
+       "(Ignored with --verbose, not with --trace)\n")
+      // option: kernel, merge duplicate species and characters
+      ("kernel,k", boost::program_options::bool_switch(&kernelization::enabled),
+       "Run the algorithm on the matrix without duplicate rows and columns.\n"
+       "(Mutually exclusive with --stream)\n")
+      // option: no-bitmatrix, always reduce the red-black graphs
+      ("no-bitmatrix",
+       boost::program_options::bool_switch()->default_value(false),
+       "Don't reduce the matrices with at most 256 rows and columns with the "
+       "bit-matrix engine.\n")
+      // option: daemon, stay resident and reduce the requested matrices
+      ("daemon", boost::program_options::bool_switch()->default_value(false),
+       "Stay resident and reduce the matrices requested on stdin (or on "
+       "--socket), with --threads workers.\n"
+       "(Mutually exclusive with --interactive)\n"
+       "(Mutually exclusive with --stream)\n")
+      // option: socket, read the requests from a Unix domain socket
+      ("socket", boost::program_options::value<std::string>(),
+       "Read the requests from the connections to the Unix domain socket "
+       "FILE.\n"
+       "(Requires --daemon)\n")
+      // option: format, print the results as records
+      ("format", boost::program_options::value<std::string>()
+                     ->default_value("text"),
+       "Print the results in FORMAT: text, or one record per file in jsonl "
+       "or csv, with the progress on stderr.\n"
+       "(Mutually exclusive with --verbose)\n"
+       "(Mutually exclusive with --stream)\n"
        "(Mutually exclusive with --interactive)\n");
 
+#ifndef NO_STATS
+  general_options.add_options()
+      // option: stats, time the phases of the algorithm
+      ("stats", boost::program_options::bool_switch(&stats::enabled),
+       "Display the time of each phase of the algorithm and the counters of "
+       "its operations, for each file and for all of them.\n");
+#endif
+
   // initialize hidden options (not shown in --help)
   boost::program_options::options_description hidden_options;
   // option: input files
@@ -91,7 +223,43 @@ int main(int argc, const char* argv[]) {
     conflicting_options(vm, "nthsource", "exponential");
     conflicting_options(vm, "nthsource", "interactive");
 
+    conflicting_options(vm, "kernel", "stream");
+
+    // the output of the daemon is the responses
+    conflicting_options(vm, "daemon", "interactive");
+    conflicting_options(vm, "daemon", "stream");
+    conflicting_options(vm, "daemon", "verbose");
+    conflicting_options(vm, "daemon", "trace");
+    conflicting_options(vm, "daemon", "stats");
+    conflicting_options(vm, "daemon", "format");
+
+    // the output of the records is the records
+    if (vm["format"].as<std::string>() != "text") {
+      conflicting_options(vm, "format", "verbose");
+      conflicting_options(vm, "format", "stream");
+      conflicting_options(vm, "format", "interactive");
+    }
+
+    option_dependency(vm, "first", "exponential");
+    option_dependency(vm, "stream", "exponential");
+    option_dependency(vm, "max-nodes", "exponential");
+    option_dependency(vm, "timeout", "exponential");
+    option_dependency(vm, "socket", "daemon");
+
+    if (vm["daemon"].as<bool>() && vm.count("files"))
+      throw std::logic_error("option --daemon doesn't take input files");
+
     boost::program_options::notify(vm);
+
+    bitmatrix::enabled = !vm["no-bitmatrix"].as<bool>();
+
+    format = output::parse_format(vm["format"].as<std::string>());
+
+#ifndef NO_TRACE
+    if (vm.count("trace")) trace::open(vm["trace"].as<std::string>());
+
+    trace::enabled = logging::enabled || trace::recording();
+#endif
   } catch (const std::exception& e) {
     // error while parsing the options given in input
     std::cerr << "Error: " << e.what() << "." << std::endl
@@ -108,6 +276,31 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
+  if (vm["daemon"].as<bool>()) {
+    // the requests are reduced in parallel, each one on a single thread
+    ServerOptions options;
+    options.workers = parallel::threads;
+    options.maximal = vm["maximal"].as<bool>();
+    options.check = vm["check"].as<bool>();
+
+    parallel::threads = 1;
+
+    solver_server server(options);
+
+    try {
+      if (vm.count("socket"))
+        server.listen(vm["socket"].as<std::string>());
+      else
+        server.serve(STDIN_FILENO, STDOUT_FILENO);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << "." << std::endl;
+
+      return 1;
+    }
+
+    return 0;
+  }
+
   if (!vm.count("files")) {
     // no input files specified
     std::cerr << "Error: No input file specified." << std::endl
@@ -117,39 +310,50 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
-  if (files.size() > 1) {
+  // results as records, through a large buffer
+  const bool records = format != output::Format::text;
+  std::unique_ptr<output::record_writer> writer;
+
+  if (records) {
+    writer.reset(
+        new output::record_writer(STDOUT_FILENO, format, stats::enabled));
+  } else if (files.size() > 1) {
     std::cout << "Running PPP on " << files.size() << " files." << std::endl
               << std::endl;
   }
 
-  boost::python::object pymod;
-
-  if (vm["testpy"].as<bool>()) {
-    // initialize the python interpreter
-    setenv("PYTHONPATH", "bin", 1);
-    Py_Initialize();
+  // progress of the run, printed at most every progress_meter::interval (on
+  // stderr with the records, if it is a terminal)
+  output::progress_meter progress(files.size());
+  const bool show_progress =
+      files.size() > 1 && (!records || isatty(STDERR_FILENO));
 
-    // import check_reduction.py
-    pymod = boost::python::import("check_reduction");
-  }
+  // statistics of all the files
+  stats::Report stats_total{};
 
   size_t count_file = 0;
   for (const auto& file : files) {
     // for each filename in files
 
-    if (logging::enabled) {
-      // verbosity enabled
+    if (records) {
+      if (show_progress && progress.due()) {
+        std::cerr << '\r' << progress.percentage(count_file) << "% ("
+                  << count_file << "/" << files.size() << ")" << std::flush;
+      }
+    } else if (logging::enabled || exponential::stream) {
+      // verbosity enabled (or reductions printed as they are found)
       std::cout << "F  (" << file << ")" << std::endl;
     } else {
       // verbosity disabled
-      if (files.size() > 1) {
-        const auto d_perc = std::floor(100.0 * count_file / files.size());
-        const auto perc = static_cast<size_t>(d_perc);
+      if (show_progress) {
+        if (progress.due()) {
+          const auto perc = progress.percentage(count_file);
 
-        if (perc < 10) std::cout << " ";
+          if (perc < 10) std::cout << " ";
 
-        std::cout << "\033[32m" << perc << "\033[39m (" << file << ")"
-                  << std::flush;
+          std::cout << "\033[32m" << perc << "\033[39m (" << file << ")"
+                    << std::flush;
+        }
       } else {
         std::cout << "F  (" << file << ")" << std::flush;
       }
@@ -157,106 +361,104 @@ int main(int argc, const char* argv[]) {
 
     count_file++;
 
+    if (trace::recording()) trace::emit(trace::Event::file, file);
+
+    // transient data structures of the reduction, freed with the instance
+    scratch_arena arena;
+    scratch_scope scope(arena);
+
     RBGraph g{};
 
-    try {
-      read_graph(file, g);
+    stats::reset();
 
-      std::stringstream keep_c{};
+    output::Record record;
+    record.file = file;
 
-      if (vm["maximal"].as<bool>()) {
-        const auto gm = maximal_reducible_graph(g);
+    const auto start = std::chrono::steady_clock::now();
 
-        if (vm["testpy"].as<bool>()) {
-          RBVertexIter v, v_end;
-          std::tie(v, v_end) = vertices(gm);
-          for (; v != v_end; ++v) {
-            if (!is_character(*v, gm)) continue;
+    try {
+      read_graph(file, g);
 
-            keep_c << g[*v].name.substr(1) << " ";
-          }
-        }
+      record.reduction =
+          reduce_matrix(g, vm["maximal"].as<bool>(), vm["check"].as<bool>());
 
-        g.clear();
-        copy_graph(gm, g);
+      if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "Realization cache: " << source_cache().hits()
+                  << " hits, " << source_cache().misses() << " misses"
+                  << std::endl
+                  << "Scratch arena: " << arena.allocations()
+                  << " allocations (" << arena.bytes() << " bytes), "
+                  << arena.heap_blocks() << " blocks (" << arena.heap_bytes()
+                  << " bytes) from the heap" << std::endl
+                  << std::endl;
       }
+    } catch (const SearchLimit& e) {
+      record.status = output::Status::unknown;
+      record.reason = e.what();
+    } catch (const std::exception& e) {
+      record.status = output::Status::no;
+      record.reason = e.what();
+    }
 
-      const auto output = reduce(g);
+    record.time = std::chrono::steady_clock::now() - start;
+
+    if (trace::recording()) {
+      // the outcome as printed with -v
+      if (record.status == output::Status::unknown)
+        trace::emit(trace::Event::unknown, file, record.reason);
+      else if (record.status == output::Status::no)
+        trace::emit(trace::Event::no, file, record.reason);
+      else if (exponential::enabled)
+        trace::emit(trace::Event::ok_logged, file);
+      else
+        trace::emit(trace::Event::ok, file, record.reduction);
+    }
 
-      std::stringstream reduction;
-      for (const auto& sc : output) {
-        reduction << sc << " ";
-      }
+    const auto report = stats::enabled ? stats::collect() : stats::Report{};
 
-      if (vm["testpy"].as<bool>()) {
-        if (vm["maximal"].as<bool>()) {
-          // run the function check_reduction(filename, reduction), store its
-          // output in pycheck
-          const auto pycheck = pymod.attr("check_reduction")(
-              file, reduction.str(), keep_c.str());
-
-          if (!boost::python::extract<bool>(pycheck)())
-            // check_reduction(filename, reduction) returned False
-            throw NoReduction();
-        } else {
-          // run the function check_reduction(filename, reduction), store its
-          // output in pycheck
-          const auto pycheck =
-              pymod.attr("check_reduction")(file, reduction.str());
-
-          if (!boost::python::extract<bool>(pycheck)())
-            // check_reduction(filename, reduction) returned False
-            throw NoReduction();
-        }
-      }
+    if (stats::enabled) stats_total += report;
 
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
+    if (records) {
+      if (stats::enabled) record.stats = &report;
 
-      std::cout << "Ok (" << file << ")";
+      try {
+        writer->write(record);
+      } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "." << std::endl;
 
-      if (logging::enabled) {
-        // verbosity enabled
-        if (exponential::enabled) {
-          // exponential algorithm enabled
-          std::cout << ": Successful reductions have been logged";
-        } else {
-          std::cout << ": < " << reduction.str() << ">";
-        }
+        return 1;
       }
 
-      std::cout << std::endl;
-    } catch (const boost::python::error_already_set& e) {
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
+      continue;
+    }
 
-      std::cout << "No (" << file << ")";
+    print_result(record);
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << ": Python error";
-      }
+    if (stats::enabled) {
+      std::cout << "Stats (" << file << "):" << std::endl
+                << report << std::endl;
+    }
+  }
 
-      std::cout << std::endl;
-    } catch (const std::exception& e) {
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
+  if (records && show_progress) {
+    // clear the progress
+    std::cerr << "\r\033[K" << std::flush;
+  }
 
-      std::cout << "No (" << file << ")";
+  if (stats::enabled && files.size() > 1 && !records) {
+    std::cout << "Stats (" << stats_total.instances << " files):" << std::endl
+              << stats_total << std::endl;
+  }
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << ": " << e.what();
-      }
+  try {
+    if (writer) writer->flush();
 
-      std::cout << std::endl;
-    }
+    trace::close();
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "." << std::endl;
+
+    return 1;
   }
 
   return 0;
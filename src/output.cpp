@@ -0,0 +1,283 @@
+#include "output.hpp"
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace output {
+
+namespace {
+
+/**
+  @brief Append \e ms milliseconds, with 3 decimals, to \e buffer
+*/
+void append_ms(std::string& buffer, const double ms) {
+  char number[32];
+  std::snprintf(number, sizeof(number), "%.3f", ms);
+  buffer += number;
+}
+
+}  // namespace
+
+constexpr std::chrono::milliseconds progress_meter::interval;
+
+Format parse_format(const std::string& name) {
+  if (name == "text") return Format::text;
+  if (name == "jsonl") return Format::jsonl;
+  if (name == "csv") return Format::csv;
+
+  throw std::invalid_argument("unknown format '" + name +
+                              "' (text, jsonl or csv)");
+}
+
+const char* status_name(const Status status) {
+  switch (status) {
+    case Status::ok:
+      return "ok";
+
+    case Status::no:
+      return "no";
+
+    default:
+      return "unknown";
+  }
+}
+
+//=============================================================================
+// record_writer
+
+record_writer::record_writer(const int fd, const Format format,
+                             const bool stats, const size_t capacity)
+    : m_fd{fd}, m_format{format}, m_stats{stats}, m_capacity{capacity} {
+  m_buffer.reserve(m_capacity);
+
+  if (m_format != Format::csv) return;
+
+  m_buffer += "file,status,reduction,reason,time_ms";
+
+  if (m_stats) {
+    for (size_t i = 0; i < stats::num_phases; ++i) {
+      m_buffer += ',';
+      m_buffer += stats::phase_name(static_cast<stats::Phase>(i));
+      m_buffer += "_ms";
+    }
+
+    for (size_t i = 0; i < stats::num_counters; ++i) {
+      m_buffer += ',';
+      m_buffer += stats::counter_name(static_cast<stats::Counter>(i));
+    }
+  }
+
+  m_buffer += '\n';
+}
+
+record_writer::~record_writer() {
+  try {
+    flush();
+  } catch (const std::exception& e) {
+    // nothing else to do with the records (e.g. closed pipe)
+  }
+}
+
+void record_writer::write(const Record& record) {
+  if (m_format == Format::jsonl)
+    write_jsonl(record);
+  else
+    write_csv(record);
+
+  if (m_buffer.size() >= m_capacity) flush();
+}
+
+void record_writer::flush() {
+  size_t written = 0;
+
+  while (written < m_buffer.size()) {
+    const auto n =
+        ::write(m_fd, m_buffer.data() + written, m_buffer.size() - written);
+
+    if (n < 0) {
+      if (errno == EINTR) continue;
+
+      m_buffer.clear();
+
+      throw std::runtime_error(std::string("can't write the results: ") +
+                               std::strerror(errno));
+    }
+
+    written += n;
+  }
+
+  m_buffer.clear();
+}
+
+void record_writer::append_string(const std::string& value) {
+  if (m_format == Format::jsonl) {
+    m_buffer += '"';
+
+    for (const auto ch : value) {
+      switch (ch) {
+        case '"':
+          m_buffer += "\\\"";
+          break;
+
+        case '\\':
+          m_buffer += "\\\\";
+          break;
+
+        case '\n':
+          m_buffer += "\\n";
+          break;
+
+        case '\r':
+          m_buffer += "\\r";
+          break;
+
+        case '\t':
+          m_buffer += "\\t";
+          break;
+
+        default:
+          if (static_cast<unsigned char>(ch) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x",
+                          static_cast<unsigned>(ch));
+            m_buffer += escape;
+          } else {
+            m_buffer += ch;
+          }
+      }
+    }
+
+    m_buffer += '"';
+
+    return;
+  }
+
+  // quoted only if needed, with the quotes doubled (RFC 4180)
+  if (value.find_first_of(",\"\r\n") == std::string::npos) {
+    m_buffer += value;
+
+    return;
+  }
+
+  m_buffer += '"';
+
+  for (const auto ch : value) {
+    if (ch == '"') m_buffer += '"';
+
+    m_buffer += ch;
+  }
+
+  m_buffer += '"';
+}
+
+void record_writer::write_jsonl(const Record& record) {
+  m_buffer += "{\"file\":";
+  append_string(record.file);
+  m_buffer += ",\"status\":\"";
+  m_buffer += status_name(record.status);
+  m_buffer += "\",\"reduction\":[";
+
+  bool first = true;
+  for (const auto& sc : record.reduction) {
+    if (!first) m_buffer += ',';
+
+    m_buffer += '"';
+    m_buffer += sc.character;
+    m_buffer += sc.state == State::gain ? "+\"" : "-\"";
+
+    first = false;
+  }
+
+  m_buffer += "],\"reason\":";
+  append_string(record.reason);
+  m_buffer += ",\"time_ms\":";
+  append_ms(m_buffer,
+            std::chrono::duration<double, std::milli>(record.time).count());
+
+  if (m_stats && record.stats != nullptr) {
+    m_buffer += ",\"phases_ms\":{";
+
+    for (size_t i = 0; i < stats::num_phases; ++i) {
+      if (i > 0) m_buffer += ',';
+
+      m_buffer += '"';
+      m_buffer += stats::phase_name(static_cast<stats::Phase>(i));
+      m_buffer += "\":";
+      append_ms(m_buffer, record.stats->time_ns[i] / 1e6);
+    }
+
+    m_buffer += "},\"counters\":{";
+
+    for (size_t i = 0; i < stats::num_counters; ++i) {
+      if (i > 0) m_buffer += ',';
+
+      m_buffer += '"';
+      m_buffer += stats::counter_name(static_cast<stats::Counter>(i));
+      m_buffer += "\":";
+      m_buffer += std::to_string(record.stats->counters[i]);
+    }
+
+    m_buffer += '}';
+  }
+
+  m_buffer += "}\n";
+}
+
+void record_writer::write_csv(const Record& record) {
+  append_string(record.file);
+  m_buffer += ',';
+  m_buffer += status_name(record.status);
+  m_buffer += ',';
+
+  // the signed characters have no separators to quote
+  bool first = true;
+  for (const auto& sc : record.reduction) {
+    if (!first) m_buffer += ' ';
+
+    m_buffer += sc.character;
+    m_buffer += sc.state == State::gain ? '+' : '-';
+
+    first = false;
+  }
+
+  m_buffer += ',';
+  append_string(record.reason);
+  m_buffer += ',';
+  append_ms(m_buffer,
+            std::chrono::duration<double, std::milli>(record.time).count());
+
+  if (m_stats) {
+    const stats::Report empty{};
+    const auto& report = record.stats != nullptr ? *record.stats : empty;
+
+    for (size_t i = 0; i < stats::num_phases; ++i) {
+      m_buffer += ',';
+      append_ms(m_buffer, report.time_ns[i] / 1e6);
+    }
+
+    for (size_t i = 0; i < stats::num_counters; ++i) {
+      m_buffer += ',';
+      m_buffer += std::to_string(report.counters[i]);
+    }
+  }
+
+  m_buffer += '\n';
+}
+
+//=============================================================================
+// progress_meter
+
+bool progress_meter::due() {
+  const auto now = std::chrono::steady_clock::now();
+
+  if (m_started && now - m_last < interval) return false;
+
+  m_started = true;
+  m_last = now;
+
+  return true;
+}
+
+}  // namespace output
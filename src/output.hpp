@@ -0,0 +1,161 @@
+#ifndef OUTPUT_HPP
+#define OUTPUT_HPP
+
+#include <chrono>
+#include <list>
+#include <string>
+#include "hdgraph.hpp"
+#include "stats.hpp"
+
+//=============================================================================
+// Batch output (ppp --format)
+//
+// With --format jsonl or csv, ppp writes one record per input file (file,
+// status, reduction, reason, time, and the statistics with --stats) to stdout
+// through a large buffer, written with a system call only when it is full and
+// at the end of the run. The progress goes to stderr, if it is a terminal, at
+// most every progress_meter::interval.
+
+namespace output {
+
+/**
+  @brief Formats of the results
+*/
+enum class Format : uint8_t {
+  text,   ///< One line per file, as printed by ppp (default)
+  jsonl,  ///< One JSON object per line
+  csv     ///< One row per file, after a header row
+};
+
+/**
+  @brief Outcomes of an input file
+*/
+enum class Status : uint8_t {
+  ok,      ///< Successful reduction
+  no,      ///< No successful reduction (or error)
+  unknown  ///< Search limit reached
+};
+
+/**
+  @brief Return the format named \e name (text, jsonl or csv)
+
+  Throws std::invalid_argument if \e name is not a format.
+*/
+Format parse_format(const std::string& name);
+
+/**
+  @brief Return the name of \e status in the records (ok, no or unknown)
+*/
+const char* status_name(const Status status);
+
+/**
+  @brief Result of an input file
+*/
+struct Record {
+  std::string file{};                        ///< Input file
+  Status status{Status::ok};                 ///< Outcome
+  std::list<SignedCharacter> reduction{};    ///< Reduction (ok)
+  std::string reason{};                      ///< Reason (no, unknown)
+  std::chrono::steady_clock::duration time{};  ///< Time to read and reduce
+  const stats::Report* stats{};              ///< Statistics, if collected
+};
+
+//=============================================================================
+// Auxiliary classes
+
+/**
+  @brief Writes the records of a run in the format given, through a buffer of
+         \e capacity bytes
+*/
+class record_writer {
+ public:
+  /**
+    @brief Record writer constructor, writes the header (csv)
+
+    @param[in] fd       File descriptor of the output
+    @param[in] format   Format of the records, jsonl or csv
+    @param[in] stats    The records have the statistics
+    @param[in] capacity Size of the buffer
+  */
+  record_writer(const int fd, const Format format, const bool stats,
+                const size_t capacity = size_t(1) << 20);
+
+  /**
+    @brief Record writer destructor, writes the rest of the buffer
+  */
+  ~record_writer();
+
+  record_writer(const record_writer&) = delete;
+  record_writer& operator=(const record_writer&) = delete;
+
+  /**
+    @brief Append \e record to the buffer
+  */
+  void write(const Record& record);
+
+  /**
+    @brief Write the buffer to the output
+
+    Throws std::runtime_error if the output can't be written.
+  */
+  void flush();
+
+ private:
+  /**
+    @brief Append \e value as a JSON string (jsonl) or a CSV field (csv)
+  */
+  void append_string(const std::string& value);
+
+  void write_jsonl(const Record& record);
+
+  void write_csv(const Record& record);
+
+  const int m_fd;
+  const Format m_format;
+  const bool m_stats;
+  const size_t m_capacity;
+  std::string m_buffer{};
+};
+
+/**
+  @brief Progress of a run, printed again only after \e interval from the
+         last time
+*/
+class progress_meter {
+ public:
+  /**
+    @brief Minimum time between two updates
+  */
+  static constexpr std::chrono::milliseconds interval{100};
+
+  /**
+    @brief Progress meter constructor
+
+    @param[in] total Number of files of the run
+  */
+  explicit progress_meter(const size_t total) : m_total{total} {}
+
+  /**
+    @brief Return true if the progress should be printed again, which is then
+           assumed to be
+
+    The first call returns true.
+  */
+  bool due();
+
+  /**
+    @brief Return the percentage of the run after \e done files
+  */
+  inline size_t percentage(const size_t done) const {
+    return m_total == 0 ? 100 : 100 * done / m_total;
+  }
+
+ private:
+  const size_t m_total;
+  std::chrono::steady_clock::time_point m_last{};
+  bool m_started{};
+};
+
+}  // namespace output
+
+#endif  // OUTPUT_HPP
@@ -0,0 +1,115 @@
+#include "parallel.hpp"
+#include <memory>
+
+//=============================================================================
+// Auxiliary structs and classes
+
+thread_pool::thread_pool(const size_t threads) {
+  for (size_t i = 1; i < threads; ++i) {
+    m_workers.emplace_back(&thread_pool::worker_loop, this);
+  }
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_job_cv.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void thread_pool::run(const size_t count,
+                      const std::function<void(size_t)>& task) {
+  if (count == 0) return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_count = count;
+    m_next = 0;
+    m_pending = count;
+    m_error = nullptr;
+    m_job++;
+  }
+
+  m_job_cv.notify_all();
+
+  // the calling thread takes part in the job too
+  work();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done_cv.wait(lock, [this] { return m_pending == 0; });
+
+  m_task = nullptr;
+
+  if (m_error) {
+    auto error = m_error;
+    m_error = nullptr;
+
+    std::rethrow_exception(error);
+  }
+}
+
+void thread_pool::work() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (m_task != nullptr && m_next < m_count) {
+    // take the next task
+    const auto index = m_next++;
+    const auto* const task = m_task;
+
+    lock.unlock();
+
+    std::exception_ptr error;
+
+    try {
+      (*task)(index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+
+    if (error && !m_error) m_error = error;
+
+    if (--m_pending == 0) m_done_cv.notify_all();
+  }
+}
+
+void thread_pool::worker_loop() {
+  size_t job = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_cv.wait(lock, [this, job] { return m_stop || m_job != job; });
+
+      if (m_stop) return;
+
+      job = m_job;
+    }
+
+    work();
+  }
+}
+
+//=============================================================================
+// General functions
+
+thread_pool& get_thread_pool() {
+  static std::unique_ptr<thread_pool> pool;
+
+  const auto threads = (parallel::threads > 0 ? parallel::threads : 1);
+
+  if (!pool || pool->size() != threads) {
+    pool.reset();
+    pool = std::make_unique<thread_pool>(threads);
+  }
+
+  return *pool;
+}
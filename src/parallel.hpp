@@ -0,0 +1,98 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "globals.hpp"
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Pool of worker threads used to run independent tasks in parallel
+
+  The workers are started once and wait for jobs: a job is a function called
+  once for each index in [0, count), indexes are handed out to the workers
+  (and to the calling thread) one at a time, so that the tasks can have very
+  different costs.
+*/
+class thread_pool {
+ public:
+  /**
+    @brief Thread pool constructor
+
+    @param[in] threads Number of threads running the tasks, calling thread
+                       included
+  */
+  thread_pool(const size_t threads);
+
+  /**
+    @brief Thread pool destructor, waits for the workers to terminate
+  */
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /**
+    @brief Call \e task for each index in [0, \e count) and wait for all the
+           calls to complete
+
+    If a call throws, the first exception is rethrown by run once every call
+    has completed.
+
+    @param[in] count Number of tasks
+    @param[in] task  Function called with the index of each task
+  */
+  void run(const size_t count, const std::function<void(size_t)>& task);
+
+  /**
+    @brief Return the number of threads running the tasks, calling thread
+           included
+
+    @return Number of threads
+  */
+  inline size_t size() const { return m_workers.size() + 1; }
+
+ private:
+  /**
+    @brief Run the tasks of the current job until there are none left
+  */
+  void work();
+
+  /**
+    @brief Main loop of each worker thread
+  */
+  void worker_loop();
+
+  std::vector<std::thread> m_workers{};
+  std::mutex m_mutex{};
+  std::condition_variable m_job_cv{};
+  std::condition_variable m_done_cv{};
+  const std::function<void(size_t)>* m_task{};
+  size_t m_count{};
+  size_t m_next{};
+  size_t m_pending{};
+  size_t m_job{};
+  bool m_stop{};
+  std::exception_ptr m_error{};
+};
+
+//=============================================================================
+// General functions
+
+/**
+  @brief Return the thread pool sized after \e parallel::threads
+
+  The pool is built on the first call and rebuilt if \e parallel::threads
+  changes.
+
+  @return Reference to the thread pool
+*/
+thread_pool& get_thread_pool();
+
+#endif  // PARALLEL_HPP
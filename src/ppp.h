@@ -0,0 +1,96 @@
+#ifndef PPP_H
+#define PPP_H
+
+/*
+  C interface of libppp (make lib): reduce binary matrices held in memory,
+  without reading files nor starting a process for each one.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define PPP_API __attribute__((visibility("default")))
+#else
+#define PPP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  Version of the interface, changed only by incompatible changes
+*/
+#define PPP_VERSION 1
+
+/**
+  @brief Outcome of ppp_solve
+*/
+typedef enum ppp_status {
+  PPP_SUCCESS = 0,           /**< The matrix has been reduced */
+  PPP_NO_REDUCTION = 1,      /**< The matrix has no successful reduction */
+  PPP_SEARCH_LIMIT = 2,      /**< The exponential search reached its limit */
+  PPP_BUFFER_TOO_SMALL = 3,  /**< The reduction doesn't fit in the buffer */
+  PPP_INVALID_ARGUMENT = 4,  /**< Empty matrix, or bad pointers or stride */
+  PPP_ERROR = 5              /**< Internal error (e.g. rejected by check) */
+} ppp_status;
+
+/**
+  @brief Options of ppp_solve, all zero by default (as the ones of ppp)
+*/
+typedef struct ppp_options {
+  int maximal;       /**< Reduce the maximal reducible graph (--maximal) */
+  int check;         /**< Check the reduction on the matrix (--check) */
+  int kernel;        /**< Reduce the kernel of the matrix (--kernel) */
+  int exponential;   /**< Exponential algorithm (--exponential) */
+  int first;         /**< Stop at the first successful reduction (--first) */
+  size_t max_nodes;  /**< Safe sources explored at most (--max-nodes) */
+  double timeout;    /**< Time limit in seconds (--timeout) */
+  int no_bitmatrix;  /**< Don't use the bit-matrix engine (--no-bitmatrix) */
+} ppp_options;
+
+/**
+  @brief Signed character of a reduction
+*/
+typedef struct ppp_step {
+  uint32_t character; /**< Index of the character (column) */
+  uint32_t gain;      /**< 1 if the character is gained, 0 if it is lost */
+} ppp_step;
+
+/**
+  @brief Return PPP_VERSION of the library
+*/
+PPP_API int ppp_version(void);
+
+/**
+  @brief Compute a successful c-reduction of a binary matrix
+
+  The cell of species (row) s and character (column) c is
+  cells[s * stride + c], any value other than 0 is a 1.
+  Calls from more threads run at the same time when they have the same
+  options, a call with different options waits for the others to complete.
+
+  @param[in]  cells      Cells of the matrix, row by row
+  @param[in]  species    Number of species (rows)
+  @param[in]  characters Number of characters (columns)
+  @param[in]  stride     Distance between the rows, at least characters
+  @param[in]  options    Options, or NULL for the default ones
+  @param[out] reduction  Buffer of the reduction, NULL if capacity is 0
+  @param[in]  capacity   Number of steps that fit in reduction
+  @param[out] length     Number of steps of the reduction (also with
+                         PPP_BUFFER_TOO_SMALL, nothing is written to
+                         reduction in that case)
+
+  @return Outcome of the reduction
+*/
+PPP_API ppp_status ppp_solve(const uint8_t* cells, size_t species,
+                             size_t characters, size_t stride,
+                             const ppp_options* options, ppp_step* reduction,
+                             size_t capacity, size_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PPP_H */
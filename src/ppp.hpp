@@ -0,0 +1,91 @@
+#ifndef PPP_HPP
+#define PPP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ppp.h"
+
+//=============================================================================
+// libppp
+//
+// C++ interface of libppp (make lib), see ppp.h for the C one. Only standard
+// types cross it, so that programs built against it don't depend on the
+// internals of the algorithm (Boost graphs, global options, ...).
+
+namespace ppp {
+
+/**
+  @brief Options of solve (see ppp_options)
+*/
+struct Options {
+  bool maximal{};        ///< Reduce the maximal reducible graph
+  bool check{};          ///< Check the reduction on the matrix
+  bool kernel{};         ///< Reduce the kernel of the matrix
+  bool exponential{};    ///< Exponential algorithm
+  bool first{};          ///< Stop at the first successful reduction
+  size_t max_nodes{};    ///< Safe sources explored at most (0 = no limit)
+  double timeout{};      ///< Time limit in seconds (0 = no limit)
+  bool bitmatrix{true};  ///< Use the bit-matrix engine when possible
+
+  inline bool operator==(const Options& other) const {
+    return maximal == other.maximal && check == other.check &&
+           kernel == other.kernel && exponential == other.exponential &&
+           first == other.first && max_nodes == other.max_nodes &&
+           timeout == other.timeout && bitmatrix == other.bitmatrix;
+  }
+};
+
+/**
+  @brief Outcome of solve (see ppp_status)
+*/
+enum class Status {
+  success,           ///< The matrix has been reduced
+  no_reduction,      ///< The matrix has no successful reduction
+  search_limit,      ///< The exponential search reached its limit
+  invalid_argument,  ///< Empty matrix, or bad pointer or stride
+  error              ///< Internal error (e.g. rejected by the check)
+};
+
+/**
+  @brief Signed character of a reduction
+*/
+struct Step {
+  uint32_t character{};  ///< Index of the character (column)
+  bool gain{};           ///< The character is gained (or lost)
+
+  inline bool operator==(const Step& other) const {
+    return character == other.character && gain == other.gain;
+  }
+};
+
+/**
+  @brief Compute a successful c-reduction of a binary matrix
+
+  The cell of species (row) s and character (column) c is
+  cells[s * stride + c], any value other than 0 is a 1.
+  The matrices that fit in the bit-matrix engine (at most 256 rows and
+  columns), with the default options, are reduced without building a
+  red-black graph. The other ones are reduced as ppp does with each file,
+  with a scratch arena kept by the calling thread and the realization cache
+  kept between the calls.
+  Calls from more threads run at the same time when they have the same
+  options, a call with different options waits for the others to complete.
+
+  @param[in]  cells      Cells of the matrix, row by row
+  @param[in]  species    Number of species (rows)
+  @param[in]  characters Number of characters (columns)
+  @param[in]  stride     Distance between the rows, at least \e characters
+  @param[out] reduction  Reduction, cleared first (its capacity is kept)
+  @param[in]  options    Options
+
+  @return Outcome of the reduction
+*/
+PPP_API Status solve(const uint8_t* cells, const size_t species,
+                     const size_t characters, const size_t stride,
+                     std::vector<Step>& reduction,
+                     const Options& options = Options());
+
+}  // namespace ppp
+
+#endif  // PPP_HPP
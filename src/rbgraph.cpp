@@ -2,7 +2,10 @@
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/copy.hpp>
 #include <boost/graph/graph_utility.hpp>
+#include <algorithm>
 #include <fstream>
+#include <unordered_map>
+#include "trace.hpp"
 
 //=============================================================================
 // Boost functions (overloading)
@@ -84,7 +87,7 @@ void build_vertex_map(RBGraph& g) {
 }
 
 void copy_graph(const RBGraph& g, RBGraph& g_copy) {
-  RBVertexIMap index_map;
+  RBVertexIMap index_map(scratch());
   RBVertexIAssocMap index_assocmap(index_map);
 
   // fill the vertex index map index_assocmap
@@ -101,12 +104,41 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy) {
   num_species(g_copy) = num_species(g);
   num_characters(g_copy) = num_characters(g);
 
+  stats::count(stats::Counter::copy_graph);
+  stats::count(stats::Counter::copied_bytes,
+               num_vertices(g_copy) * sizeof(RBVertexProperties) +
+                   num_edges(g_copy) * sizeof(RBEdgeProperties));
+
   // rebuild g_copy's map
   build_vertex_map(g_copy);
 }
 
+size_t num_species(const RBGraphView& g) {
+  size_t count = 0;
+
+  RBViewVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_species(*v, g)) count++;
+  }
+
+  return count;
+}
+
+size_t num_characters(const RBGraphView& g) {
+  size_t count = 0;
+
+  RBViewVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_character(*v, g)) count++;
+  }
+
+  return count;
+}
+
 void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map) {
-  RBVertexIMap index_map;
+  RBVertexIMap index_map(scratch());
   RBVertexAssocMap v_assocmap(v_map);
   RBVertexIAssocMap index_assocmap(index_map);
 
@@ -125,10 +157,97 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map) {
   num_species(g_copy) = num_species(g);
   num_characters(g_copy) = num_characters(g);
 
+  stats::count(stats::Counter::copy_graph);
+  stats::count(stats::Counter::copied_bytes,
+               num_vertices(g_copy) * sizeof(RBVertexProperties) +
+                   num_edges(g_copy) * sizeof(RBEdgeProperties));
+
   // rebuild g_copy's map
   build_vertex_map(g_copy);
 }
 
+void copy_graph(const RBGraphView& g, RBGraph& g_copy) {
+  RBVertexMap v_map(scratch());
+
+  // copy the vertices in the view, in order
+  RBViewVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    const auto u = boost::add_vertex(g_copy);
+    g_copy[u] = g[*v];
+
+    if (is_species(u, g_copy))
+      num_species(g_copy)++;
+    else
+      num_characters(g_copy)++;
+
+    v_map[*v] = u;
+  }
+
+  // copy the edges in the view, in order
+  RBViewEdgeIter e, e_end;
+  std::tie(e, e_end) = edges(g);
+  for (; e != e_end; ++e) {
+    add_edge(v_map[source(*e, g)], v_map[target(*e, g)], g[*e].color, g_copy);
+  }
+
+  stats::count(stats::Counter::copy_graph);
+  stats::count(stats::Counter::copied_bytes,
+               num_vertices(g_copy) * sizeof(RBVertexProperties) +
+                   num_edges(g_copy) * sizeof(RBEdgeProperties));
+
+  // rebuild g_copy's map
+  build_vertex_map(g_copy);
+}
+
+std::string fingerprint(const RBGraph& g) {
+  std::vector<std::string> lines;
+  lines.reserve(num_vertices(g));
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    std::string line(g[*v].name);
+
+    if (is_character(*v, g)) {
+      // the edges of characters are already in the lines of the species
+      lines.push_back(line.append(":"));
+
+      continue;
+    }
+
+    std::vector<std::string> edges;
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      edges.push_back(g[target(*e, g)].name + (is_red(*e, g) ? "r" : "b"));
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    line += "|";
+
+    for (const auto& edge : edges) {
+      line += edge;
+      line += ",";
+    }
+
+    lines.push_back(line);
+  }
+
+  std::sort(lines.begin(), lines.end());
+
+  std::string output;
+
+  for (const auto& line : lines) {
+    output += line;
+    output += ";";
+  }
+
+  return output;
+}
+
 std::ostream& operator<<(std::ostream& os, const RBGraph& g) {
   std::list<std::string> lines;
   std::list<std::string> species;
@@ -215,12 +334,16 @@ std::ostream& operator<<(std::ostream& os, const RBGraph& g) {
   return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const RBGraphView& g) {
+  RBGraph g_copy;
+  copy_graph(g, g_copy);
+
+  return os << g_copy;
+}
+
 // File I/O
 
 void read_graph(const std::string& filename, RBGraph& g) {
-  std::vector<RBVertex> species, characters;
-  bool first_line = true;
-  std::string line;
   std::ifstream file(filename);
 
   if (!file) {
@@ -229,8 +352,18 @@ void read_graph(const std::string& filename, RBGraph& g) {
         "Failed to read graph from file: no such file or directory");
   }
 
+  read_graph(file, g);
+}
+
+void read_graph(std::istream& is, RBGraph& g) {
+  const stats::scoped_timer timer(stats::Phase::parse);
+
+  std::vector<RBVertex> species, characters;
+  bool first_line = true;
+  std::string line;
+
   size_t index = 0;
-  while (std::getline(file, line)) {
+  while (std::getline(is, line)) {
     // for each line in file
     std::istringstream iss(line);
 
@@ -362,10 +495,82 @@ void remove_singletons(RBGraph& g) {
   }
 }
 
+RBKernel kernelize(RBGraph& g) {
+  RBKernel output;
+
+  // key of a vertex: the sorted names (and colors) of its adjacent vertices
+  auto key = [&g](const RBVertex v) {
+    std::vector<std::string> names;
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(v, g);
+    for (; e != e_end; ++e) {
+      names.push_back(g[target(*e, g)].name + (is_red(*e, g) ? "r" : "b"));
+    }
+
+    std::sort(names.begin(), names.end());
+
+    std::string k;
+    for (const auto& name : names) {
+      k += name;
+      k += ",";
+    }
+
+    return k;
+  };
+
+  // merge the duplicate vertices of type type into the first one found, in
+  // vertex order (species have to be merged before the keys of the characters
+  // are built, and vice versa)
+  auto merge = [&g, &key](const Type type,
+                          std::map<std::string, std::list<std::string>>& dup) {
+    std::unordered_map<std::string, RBVertex> representative;
+
+    RBVertexIter v, v_end, next;
+    std::tie(v, v_end) = vertices(g);
+    for (next = v; v != v_end; v = next) {
+      next++;
+
+      if (g[*v].type != type || out_degree(*v, g) == 0) continue;
+
+      const auto in = representative.emplace(key(*v), *v);
+
+      if (in.second)
+        // first vertex with these adjacent vertices
+        continue;
+
+      dup[g[in.first->second].name].push_back(g[*v].name);
+
+      clear_vertex(*v, g);
+      remove_vertex(*v, g);
+    }
+  };
+
+  merge(Type::species, output.species);
+  merge(Type::character, output.characters);
+
+  if (trace::enabled) {
+    // trace enabled
+    size_t count_s = 0, count_c = 0;
+
+    for (const auto& kv : output.species) {
+      count_s += kv.second.size();
+    }
+
+    for (const auto& kv : output.characters) {
+      count_c += kv.second.size();
+    }
+
+    trace::emit(trace::Event::kernel, count_s, count_c);
+  }
+
+  return output;
+}
+
 bool is_free(const RBVertex v, const RBGraph& g) {
   if (!is_character(v, g)) return false;
 
-  RBVertexIMap index_map, comp_map;
+  RBVertexIMap index_map(scratch()), comp_map(scratch());
   RBVertexIAssocMap index_assocmap(index_map), comp_assocmap(comp_map);
 
   // fill vertex index map
@@ -376,6 +581,7 @@ bool is_free(const RBVertex v, const RBGraph& g) {
   }
 
   // build the components map
+  stats::count(stats::Counter::components);
   boost::connected_components(g, comp_assocmap,
                               boost::vertex_index_map(index_assocmap));
 
@@ -413,7 +619,7 @@ bool is_free(const RBVertex v, const RBGraph& g, const RBVertexIMap& c_map) {
 bool is_universal(const RBVertex v, const RBGraph& g) {
   if (!is_character(v, g)) return false;
 
-  RBVertexIMap index_map, comp_map;
+  RBVertexIMap index_map(scratch()), comp_map(scratch());
   RBVertexIAssocMap index_assocmap(index_map), comp_assocmap(comp_map);
 
   // fill vertex index map
@@ -424,6 +630,7 @@ bool is_universal(const RBVertex v, const RBGraph& g) {
   }
 
   // build the components map
+  stats::count(stats::Counter::components);
   boost::connected_components(g, comp_assocmap,
                               boost::vertex_index_map(index_assocmap));
 
@@ -459,8 +666,57 @@ bool is_universal(const RBVertex v, const RBGraph& g,
   return true;
 }
 
+std::vector<size_t> count_species(const RBGraph& g, const RBVertexIMap& c_map,
+                                  const size_t c_count) {
+  std::vector<size_t> c_species(c_count, 0);
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (!is_species(*v, g)) continue;
+
+    c_species[c_map.at(*v)]++;
+  }
+
+  return c_species;
+}
+
+bool is_free(const RBVertex v, const RBGraph& g, const RBVertexIMap& c_map,
+             const std::vector<size_t>& c_species) {
+  if (!is_character(v, g)) return false;
+
+  size_t count_species = 0;
+
+  RBOutEdgeIter e, e_end;
+  std::tie(e, e_end) = out_edges(v, g);
+  for (; e != e_end; ++e) {
+    if (!is_red(*e, g) || !is_species(target(*e, g), g)) return false;
+
+    count_species++;
+  }
+
+  return count_species == c_species[c_map.at(v)];
+}
+
+bool is_universal(const RBVertex v, const RBGraph& g, const RBVertexIMap& c_map,
+                  const std::vector<size_t>& c_species) {
+  if (!is_character(v, g)) return false;
+
+  size_t count_species = 0;
+
+  RBOutEdgeIter e, e_end;
+  std::tie(e, e_end) = out_edges(v, g);
+  for (; e != e_end; ++e) {
+    if (!is_black(*e, g) || !is_species(target(*e, g), g)) return false;
+
+    count_species++;
+  }
+
+  return count_species == c_species[c_map.at(v)];
+}
+
 RBGraphVector connected_components(const RBGraph& g) {
-  RBVertexIMap index_map, comp_map;
+  RBVertexIMap index_map(scratch()), comp_map(scratch());
   RBVertexIAssocMap index_assocmap(index_map), comp_assocmap(comp_map);
 
   // fill the vertex index map index_assocmap
@@ -471,6 +727,7 @@ RBGraphVector connected_components(const RBGraph& g) {
   }
 
   // get number of components and the components map
+  stats::count(stats::Counter::components);
   size_t comp_count = boost::connected_components(
       g, comp_assocmap, boost::vertex_index_map(index_assocmap));
 
@@ -483,10 +740,10 @@ RBGraphVector connected_components(const RBGraph& g) {
 RBGraphVector connected_components(const RBGraph& g, const RBVertexIMap& c_map,
                                    const size_t c_count) {
   RBGraphVector components;
-  RBVertexMap vertices;
+  RBVertexMap vmap(scratch());
 
-  // how vertices is going to be structured:
-  // vertices[vertex_in_g] => vertex_in_component
+  // how vmap is going to be structured:
+  // vmap[vertex_in_g] => vertex_in_component
 
   // resize subgraph components
   components.resize(c_count);
@@ -502,34 +759,36 @@ RBGraphVector connected_components(const RBGraph& g, const RBVertexIMap& c_map,
 
   // graph is disconnected
 
-  // add vertices to their respective subgraph
-  for (const auto& vcomp : c_map) {
+  // add vertices to their respective subgraph, in the order of g (c_map is
+  // ordered by vertex descriptor, which depends on the memory layout)
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
     // for each vertex
-    const auto v = vcomp.first;
-    const auto comp = vcomp.second;
+    const auto comp = c_map.at(*v);
     auto* const component = components[comp].get();
 
-    // add the vertex to *component and copy its descriptor in vertices[v]
-    vertices[v] = add_vertex(g[v].name, g[v].type, *component);
+    // add the vertex to *component and copy its descriptor in vmap[v]
+    vmap[*v] = add_vertex(g[*v].name, g[*v].type, *component);
   }
 
   // add edges to their respective vertices and subgraph
-  for (const auto& vcomp : c_map) {
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
     // for each vertex
-    const auto v = vcomp.first;
 
     // prevent duplicate edges from characters to species
-    if (!is_species(v, g)) continue;
+    if (!is_species(*v, g)) continue;
 
-    const auto new_v = vertices[v];
-    const auto comp = vcomp.second;
+    const auto new_v = vmap[*v];
+    const auto comp = c_map.at(*v);
     auto* const component = components[comp].get();
 
     RBOutEdgeIter e, e_end;
-    std::tie(e, e_end) = out_edges(v, g);
+    std::tie(e, e_end) = out_edges(*v, g);
     for (; e != e_end; ++e) {
       // for each out edge
-      const auto new_vt = vertices[target(*e, g)];
+      const auto new_vt = vmap[target(*e, g)];
 
       bool exists;
       std::tie(std::ignore, exists) = edge(new_v, new_vt, *component);
@@ -541,24 +800,18 @@ RBGraphVector connected_components(const RBGraph& g, const RBVertexIMap& c_map,
     }
   }
 
-  if (logging::enabled) {
-    if (c_count == 1) {
-      std::cout << "G connected" << std::endl;
-    } else {
-      std::cout << "Connected components: " << c_count << std::endl;
-
-      for (const auto& component : components) {
-        std::cout << *component.get() << std::endl << std::endl;
-      }
-    }
-  }
+  if (c_count == 1)
+    trace::emit(trace::Event::connected);
+  else
+    trace::emit(trace::Event::components, c_count, components);
 
   return components;
 }
 
 const std::list<RBVertex> maximal_characters(const RBGraph& g) {
   std::list<RBVertex> cm;
-  std::map<RBVertex, std::list<RBVertex>> adj_spec;
+  boost::container::pmr::map<RBVertex, boost::container::pmr::list<RBVertex>>
+      adj_spec(scratch());
 
   // how adj_spec is going to be structured:
   // adj_spec[C] => < List of adjacent species to C >
@@ -602,12 +855,13 @@ const std::list<RBVertex> maximal_characters(const RBGraph& g) {
       size_t count_excl = 0;
       bool keep_char = false;
 
-      RBVertexIter sv = adj_spec[*v].begin(), sv_end = adj_spec[*v].end();
+      const auto& spec_v = adj_spec[*v];
+      auto sv = spec_v.cbegin(), sv_end = spec_v.cend();
       for (; sv != sv_end; ++sv) {
         // for each species adjacent to v, S(C#)
 
         // find sv in the list of cmv's adjacent species
-        std::list<RBVertex>::const_iterator in =
+        const auto in =
             std::find(adj_spec[*cmv].cbegin(), adj_spec[*cmv].cend(), *sv);
 
         // keep count of how many species are included (or not found) in
@@ -671,47 +925,88 @@ const std::list<RBVertex> maximal_characters(const RBGraph& g) {
 }
 
 RBGraph maximal_reducible_graph(const RBGraph& g, const bool active) {
-  // copy g to gm
+  const stats::scoped_timer timer(stats::Phase::maximal);
+
+  // copy the maximal reducible graph of g to gm
   RBGraph gm;
-  copy_graph(g, gm);
+  copy_graph(maximal_reducible_view(g, active), gm);
+
+  return gm;
+}
+
+RBGraph maximal_reducible_graph(const RBGraph& g,
+                                const std::set<std::string>& cm,
+                                const bool active) {
+  // copy the maximal reducible graph of g to gm
+  RBGraph gm;
+  copy_graph(maximal_reducible_view(g, cm, active), gm);
+
+  return gm;
+}
 
-  // compute the maximal characters of gm
-  const auto cm = maximal_characters(gm);
+RBGraphView maximal_reducible_view(const RBGraph& g, const bool active) {
+  // compute the maximal characters of g
+  const auto cm = maximal_characters(g);
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Maximal characters Cm = { ";
+  if (trace::enabled) {
+    // trace enabled
+    std::list<std::string> cm_list;
 
     for (const auto& kk : cm) {
-      std::cout << gm[kk].name << " ";
+      cm_list.push_back(g[kk].name);
     }
 
-    std::cout << "} - Count: " << cm.size() << std::endl;
+    trace::emit(trace::Event::maximal, cm_list, cm.size());
   }
 
-  // remove non-maximal characters of gm
-  RBVertexIter v, v_end, next;
-  std::tie(v, v_end) = vertices(gm);
-  for (next = v; v != v_end; v = next) {
-    next++;
+  std::set<std::string> cm_names;
+
+  for (const auto& kk : cm) {
+    cm_names.insert(g[kk].name);
+  }
 
-    if (!is_character(*v, gm))
-      // don't remove non-character vertices
+  return maximal_reducible_view(g, cm_names, active);
+}
+
+RBGraphView maximal_reducible_view(const RBGraph& g,
+                                   const std::set<std::string>& cm,
+                                   const bool active) {
+  auto gm_vertices = std::make_shared<std::unordered_set<RBVertex>>();
+
+  // keep the maximal (and active) characters of g, with their species: the
+  // species left without characters and the characters without species are
+  // singletons, which are not in the view
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (!is_character(*v, g))
+      // species are kept with their characters
       continue;
 
-    if (active && is_active(*v, gm))
-      // don't remove active or non-character vertices
+    if (!(active && is_active(*v, g)) && cm.count(g[*v].name) == 0)
+      // non-maximal character
       continue;
 
-    remove_vertex_if(*v, if_not_maximal(cm), gm);
-  }
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
 
-  remove_singletons(gm);
+    if (e == e_end)
+      // singleton character
+      continue;
 
-  return gm;
+    gm_vertices->insert(*v);
+
+    for (; e != e_end; ++e) {
+      gm_vertices->insert(target(*e, g));
+    }
+  }
+
+  return RBGraphView(g, boost::keep_all(), RBVertexFilter{gm_vertices});
 }
 
 bool has_red_sigmagraph(const RBGraph& g) {
+  stats::count(stats::Counter::sigma_tests);
+
   size_t count_actives = 0;
 
   RBVertexIter v, v_end;
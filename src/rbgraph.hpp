@@ -1,8 +1,16 @@
 #ifndef RBGRAPH_HPP
 #define RBGRAPH_HPP
 
+#include <boost/container/pmr/list.hpp>
+#include <boost/container/pmr/map.hpp>
 #include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/filtered_graph.hpp>
 #include <iostream>
+#include <memory>
+#include <set>
+#include <unordered_set>
+#include "arena.hpp"
+#include "stats.hpp"
 #include "globals.hpp"
 
 //=============================================================================
@@ -131,9 +139,10 @@ typedef boost::graph_traits<RBGraph>::vertices_size_type RBVertexSize;
 // Maps
 
 /**
-  Map of vertex indexes (red-black graph)
+  Map of vertex indexes (red-black graph), built with scratch() when it's
+  transient
 */
-typedef std::map<RBVertex, RBVertexSize> RBVertexIMap;
+typedef boost::container::pmr::map<RBVertex, RBVertexSize> RBVertexIMap;
 
 /**
   Associative property map of vertex indexes (red-black graph)
@@ -141,9 +150,9 @@ typedef std::map<RBVertex, RBVertexSize> RBVertexIMap;
 typedef boost::associative_property_map<RBVertexIMap> RBVertexIAssocMap;
 
 /**
-  Map of vertices (red-black graph)
+  Map of vertices (red-black graph), built with scratch() when it's transient
 */
-typedef std::map<RBVertex, RBVertex> RBVertexMap;
+typedef boost::container::pmr::map<RBVertex, RBVertex> RBVertexMap;
 
 /**
   Associative property map of vertices (red-black graph)
@@ -160,6 +169,63 @@ typedef std::vector<std::unique_ptr<RBGraph>> RBGraphVector;
 //=============================================================================
 // Auxiliary structs and classes
 
+/**
+  @brief Functor used to select the vertices of a red-black graph that are in
+         a view of the graph (see RBGraphView)
+*/
+struct RBVertexFilter {
+  std::shared_ptr<const std::unordered_set<RBVertex>>
+      vertices{};  ///< Vertices in the view (all of them if null)
+
+  /**
+    @brief Overloading of operator() for RBVertexFilter
+
+    @param[in] v Vertex
+
+    @return True if \e v is in the view
+  */
+  inline bool operator()(const RBVertex v) const {
+    return (vertices == nullptr || vertices->count(v) > 0);
+  }
+};
+
+/**
+  Red-black graph induced by a subset of the vertices of another red-black
+  graph, which is not copied (view). The view is valid as long as the viewed
+  graph is not modified.
+*/
+typedef boost::filtered_graph<RBGraph, boost::keep_all, RBVertexFilter>
+    RBGraphView;
+
+/**
+  Iterator of vertices (red-black graph view)
+*/
+typedef boost::graph_traits<RBGraphView>::vertex_iterator RBViewVertexIter;
+
+/**
+  Iterator of outgoing edges (red-black graph view)
+*/
+typedef boost::graph_traits<RBGraphView>::out_edge_iterator RBViewOutEdgeIter;
+
+/**
+  Iterator of edges (red-black graph view)
+*/
+typedef boost::graph_traits<RBGraphView>::edge_iterator RBViewEdgeIter;
+
+/**
+  @brief Struct used to represent the duplicate species and characters merged
+         into their representatives by \e kernelize
+
+  The multiplicity of a representative is the number of its duplicates plus
+  one.
+*/
+struct RBKernel {
+  std::map<std::string, std::list<std::string>>
+      species{};  ///< Duplicate species of each representative species
+  std::map<std::string, std::list<std::string>>
+      characters{};  ///< Duplicate characters of each representative character
+};
+
 /**
   @brief Functor used in remove_vertex_if
 */
@@ -330,6 +396,30 @@ inline const size_t num_characters(const RBGraph& g) {
   return g[boost::graph_bundle].num_characters;
 }
 
+/**
+  @brief Return the number of species in the view \e g
+
+  The species are counted, so this takes linear time in the number of vertices
+  of the viewed graph.
+
+  @param[in] g Red-black graph view
+
+  @return Number of species in \e g
+*/
+size_t num_species(const RBGraphView& g);
+
+/**
+  @brief Return the number of characters in the view \e g
+
+  The characters are counted, so this takes linear time in the number of
+  vertices of the viewed graph.
+
+  @param[in] g Red-black graph view
+
+  @return Number of characters in \e g
+*/
+size_t num_characters(const RBGraphView& g);
+
 /**
   @brief Return the map in \e g
 
@@ -387,6 +477,19 @@ inline const RBVertex get_vertex(const std::string& name, const RBGraph& g) {
   return vertex_map(g).at(name);
 }
 
+/**
+  @brief Return the vertex descriptor of the vertex \e name in the view \e g
+
+  @param[in] name Vertex name (the vertex must be in the view)
+  @param[in] g    Red-black graph view
+
+  @return Vertex
+*/
+inline const RBVertex get_vertex(const std::string& name,
+                                 const RBGraphView& g) {
+  return get_vertex(name, g.m_g);
+}
+
 /**
   @brief Copy graph \e g to graph \e g_copy
 
@@ -404,6 +507,31 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy);
 */
 void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map);
 
+/**
+  @brief Copy the view \e g to graph \e g_copy (materialize the view)
+
+  The vertices and the edges are copied in the same order as \e copy_graph
+  would copy them from the viewed graph.
+
+  @param[in]     g      Red-black graph view
+  @param[in,out] g_copy Red-black graph
+*/
+void copy_graph(const RBGraphView& g, RBGraph& g_copy);
+
+/**
+  @brief Return a fingerprint of graph \e g
+
+  The fingerprint is a canonical text representation of the vertices and the
+  edges of \e g: it doesn't depend on the order of the vertices or of the
+  edges, so two graphs have the same fingerprint if and only if they have the
+  same species, characters and (colored) edges.
+
+  @param[in] g Red-black graph
+
+  @return Fingerprint of \e g
+*/
+std::string fingerprint(const RBGraph& g);
+
 /**
   @brief Overloading of operator<< for RBGraph
 
@@ -414,6 +542,16 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map);
 */
 std::ostream& operator<<(std::ostream& os, const RBGraph& g);
 
+/**
+  @brief Overloading of operator<< for RBGraphView
+
+  @param[in] os Output stream
+  @param[in] g  Red-black graph view
+
+  @return Updated output stream
+*/
+std::ostream& operator<<(std::ostream& os, const RBGraphView& g);
+
 // File I/O
 
 /**
@@ -424,6 +562,14 @@ std::ostream& operator<<(std::ostream& os, const RBGraph& g);
 */
 void read_graph(const std::string& filename, RBGraph& g);
 
+/**
+  @brief Read the matrix in \e is, in the format of the input files, into \e g
+
+  @param[in]  is Input stream
+  @param[out] g  Red-black graph
+*/
+void read_graph(std::istream& is, RBGraph& g);
+
 //=============================================================================
 // Algorithm functions
 
@@ -475,6 +621,54 @@ inline bool is_red(const RBEdge e, const RBGraph& g) {
   return (g[e].color == Color::red);
 }
 
+/**
+  @brief Check if \e v is a species in the view \e g
+
+  @param[in] v Vertex
+  @param[in] g Red-black graph view
+
+  @return True if \e v is a species in \e g
+*/
+inline bool is_species(const RBVertex v, const RBGraphView& g) {
+  return (g[v].type == Type::species);
+}
+
+/**
+  @brief Check if \e v is a character in the view \e g
+
+  @param[in] v Vertex
+  @param[in] g Red-black graph view
+
+  @return True if \e v is a character in \e g
+*/
+inline bool is_character(const RBVertex v, const RBGraphView& g) {
+  return (g[v].type == Type::character);
+}
+
+/**
+  @brief Check if \e e is a black edge in the view \e g
+
+  @param[in] e Edge
+  @param[in] g Red-black graph view
+
+  @return True if \e e is a black edge in \e g
+*/
+inline bool is_black(const RBEdge e, const RBGraphView& g) {
+  return (g[e].color == Color::black);
+}
+
+/**
+  @brief Check if \e e is a red edge in the view \e g
+
+  @param[in] e Edge
+  @param[in] g Red-black graph view
+
+  @return True if \e e is a red edge in \e g
+*/
+inline bool is_red(const RBEdge e, const RBGraphView& g) {
+  return (g[e].color == Color::red);
+}
+
 /**
   @brief Check if \e v is active in \e g
 
@@ -510,6 +704,23 @@ bool is_inactive(const RBVertex v, const RBGraph& g);
 */
 void remove_singletons(RBGraph& g);
 
+/**
+  @brief Remove the duplicate species and characters from \e g, keeping the
+         first one of each group as its representative (kernel of \e g)
+
+  Species with the same characters (and colors) are equivalent in every step
+  of the reduction, so only one of them is kept.
+  Characters with the same species (and colors) are equivalent too, so each
+  one is realized along with its representative: a c-reduction of the kernel
+  becomes a c-reduction of \e g by realizing the duplicates of each character
+  right after it (see \e expand_reduction).
+
+  @param[in,out] g Red-black graph
+
+  @return Duplicates removed from \e g
+*/
+RBKernel kernelize(RBGraph& g);
+
 /**
   @brief Check if \e g is empty
 
@@ -576,6 +787,50 @@ bool is_universal(const RBVertex v, const RBGraph& g);
 bool is_universal(const RBVertex v, const RBGraph& g,
                   const RBVertexIMap& c_map);
 
+/**
+  @brief Count the species in each connected component of \e g
+
+  @param[in] g       Red-black graph
+  @param[in] c_map   Components map of \e g
+  @param[in] c_count Number of connected components of \e g
+
+  @return Number of species of each component, indexed by component
+*/
+std::vector<size_t> count_species(const RBGraph& g, const RBVertexIMap& c_map,
+                                  const size_t c_count);
+
+/**
+  @brief Check if \e v is free in \e g
+
+  Takes time linear in the degree of \e v, since the species of each component
+  are counted beforehand by count_species.
+
+  @param[in] v         Vertex
+  @param[in] g         Red-black graph
+  @param[in] c_map     Components map of \e g
+  @param[in] c_species Number of species of each component of \e g
+
+  @return True if \e v is free in \e g
+*/
+bool is_free(const RBVertex v, const RBGraph& g, const RBVertexIMap& c_map,
+             const std::vector<size_t>& c_species);
+
+/**
+  @brief Check if \e v is universal in \e g
+
+  Takes time linear in the degree of \e v, since the species of each component
+  are counted beforehand by count_species.
+
+  @param[in] v         Vertex
+  @param[in] g         Red-black graph
+  @param[in] c_map     Components map of \e g
+  @param[in] c_species Number of species of each component of \e g
+
+  @return True if \e v is universal in \e g
+*/
+bool is_universal(const RBVertex v, const RBGraph& g, const RBVertexIMap& c_map,
+                  const std::vector<size_t>& c_species);
+
 /**
   @brief Build the red-black subgraphs of \e g.
          Each subgraph is a copy of the respective connected component
@@ -641,6 +896,54 @@ const std::list<RBVertex> maximal_characters(const RBGraph& g);
 */
 RBGraph maximal_reducible_graph(const RBGraph& g, const bool active = false);
 
+/**
+  @brief Build the maximal reducible red-black graph of \e g, given the names
+         of its maximal characters \e cm
+
+  @param[in] g      Red-black graph
+  @param[in] cm     Names of the maximal characters of \e g
+  @param[in] active True: keep all active characters from \e g (GRB|CM∪A);
+                    False: ignore all active characters from \e g (GRB|CM).
+
+  @return Maximal reducible graph
+*/
+RBGraph maximal_reducible_graph(const RBGraph& g,
+                                const std::set<std::string>& cm,
+                                const bool active = false);
+
+/**
+  @brief Build a view of the maximal reducible red-black graph of \e g
+
+  Same as \e maximal_reducible_graph, but \e g is not copied: the vertices of
+  the maximal reducible graph are selected in \e g. Use
+  \e maximal_reducible_graph (or \e copy_graph on the view) when the graph
+  has to be modified.
+
+  @param[in] g      Red-black graph
+  @param[in] active True: keep all active characters from \e g (GRB|CM∪A);
+                    False: ignore all active characters from \e g (GRB|CM).
+
+  @return View of the maximal reducible graph, valid as long as \e g is not
+          modified
+*/
+RBGraphView maximal_reducible_view(const RBGraph& g, const bool active = false);
+
+/**
+  @brief Build a view of the maximal reducible red-black graph of \e g, given
+         the names of its maximal characters \e cm
+
+  @param[in] g      Red-black graph
+  @param[in] cm     Names of the maximal characters of \e g
+  @param[in] active True: keep all active characters from \e g (GRB|CM∪A);
+                    False: ignore all active characters from \e g (GRB|CM).
+
+  @return View of the maximal reducible graph, valid as long as \e g is not
+          modified
+*/
+RBGraphView maximal_reducible_view(const RBGraph& g,
+                                   const std::set<std::string>& cm,
+                                   const bool active = false);
+
 /**
   @brief Check if \e g contains a red Σ-graph
 
@@ -0,0 +1,334 @@
+#include "server.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "functions.hpp"
+
+namespace {
+
+/**
+  Longest header line of a request
+*/
+constexpr size_t max_header = 4096;
+
+/**
+  Longest payload of a request
+*/
+constexpr size_t max_payload = size_t(1) << 30;
+
+/**
+  @brief Buffered reader of the frames of a file descriptor
+*/
+class frame_reader {
+ public:
+  explicit frame_reader(const int fd) : m_fd(fd), m_buffer(1 << 16) {}
+
+  /**
+    @brief Read a line (without the newline) into \e line
+
+    @return False at the end of the input, or if the line is too long
+  */
+  bool read_line(std::string& line) {
+    line.clear();
+
+    while (true) {
+      if (m_pos == m_end && !fill()) return false;
+
+      const auto begin = m_buffer.data() + m_pos;
+      const auto newline =
+          static_cast<const char*>(std::memchr(begin, '\n', m_end - m_pos));
+
+      if (newline != nullptr) {
+        line.append(begin, newline - begin);
+        m_pos += newline - begin + 1;
+
+        return line.size() <= max_header;
+      }
+
+      line.append(begin, m_end - m_pos);
+      m_pos = m_end;
+
+      if (line.size() > max_header) return false;
+    }
+  }
+
+  /**
+    @brief Read \e n bytes into \e data
+
+    @return False if the input ends first
+  */
+  bool read(const size_t n, std::string& data) {
+    data.clear();
+    data.reserve(n);
+
+    while (data.size() < n) {
+      if (m_pos == m_end && !fill()) return false;
+
+      const auto count = std::min(n - data.size(), m_end - m_pos);
+
+      data.append(m_buffer.data() + m_pos, count);
+      m_pos += count;
+    }
+
+    return true;
+  }
+
+ private:
+  bool fill() {
+    ssize_t count;
+
+    do {
+      count = ::read(m_fd, m_buffer.data(), m_buffer.size());
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) return false;
+
+    m_pos = 0;
+    m_end = count;
+
+    return true;
+  }
+
+  const int m_fd;
+  std::vector<char> m_buffer;
+  size_t m_pos{};
+  size_t m_end{};
+};
+
+/**
+  @brief Parse the header \e line of a request (ID KIND LENGTH)
+
+  @return False if \e line is badly formatted
+*/
+bool parse_header(const std::string& line, std::string& id, std::string& kind,
+                  size_t& length) {
+  std::istringstream iss(line);
+  std::string rest;
+
+  if (!(iss >> id >> kind >> length) || (iss >> rest)) return false;
+
+  return length <= max_payload;
+}
+
+/**
+  @brief Write \e data to \e fd, give up if the client is gone
+*/
+void write_all(const int fd, const std::string& data) {
+  size_t written = 0;
+
+  while (written < data.size()) {
+    // send doesn't raise SIGPIPE when the client closes the socket
+    auto count =
+        send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+
+    if (count < 0 && errno == ENOTSOCK)
+      count = write(fd, data.data() + written, data.size() - written);
+
+    if (count < 0 && errno == EINTR) continue;
+
+    if (count <= 0) return;
+
+    written += count;
+  }
+}
+
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+solver_server::solver_server(const ServerOptions& options)
+    : m_options(options) {
+  const auto workers = (options.workers > 0 ? options.workers : 1);
+
+  for (size_t i = 0; i < workers; ++i) {
+    m_workers.emplace_back(&solver_server::worker_loop, this);
+  }
+}
+
+solver_server::~solver_server() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_job_cv.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void solver_server::serve(const int in, const int out) {
+  auto connection = std::make_shared<Connection>();
+  connection->out = out;
+
+  const auto respond = [&connection](const std::string& id,
+                                     const std::string& message) {
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    write_all(connection->out, id + " error " +
+                                   std::to_string(message.size()) + "\n" +
+                                   message);
+  };
+
+  frame_reader reader(in);
+  std::string line;
+
+  while (reader.read_line(line)) {
+    // empty lines between the requests are skipped
+    if (line.empty()) continue;
+
+    std::string id, kind, payload;
+    size_t length = 0;
+
+    if (!parse_header(line, id, kind, length) ||
+        !reader.read(length, payload)) {
+      // the next request can't be found, the input is dropped
+      respond(id.empty() ? "-" : id, "Badly formatted request");
+
+      break;
+    }
+
+    if (kind != "path" && kind != "matrix") {
+      respond(id, "Unknown request kind " + kind);
+
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(connection->mutex);
+      connection->pending++;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_jobs.push_back(Job{connection, id, kind, std::move(payload)});
+    }
+
+    m_job_cv.notify_one();
+  }
+
+  // wait for the responses of the requests read
+  std::unique_lock<std::mutex> lock(connection->mutex);
+  connection->done_cv.wait(lock,
+                           [&connection] { return connection->pending == 0; });
+}
+
+void solver_server::listen(const std::string& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("Socket path too long: " + path);
+
+  std::strcpy(address.sun_path, path.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (fd < 0) throw std::runtime_error(std::strerror(errno));
+
+  // a socket left by a previous server is replaced
+  unlink(path.c_str());
+
+  if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) <
+          0 ||
+      ::listen(fd, SOMAXCONN) < 0) {
+    const std::string error = path + ": " + std::strerror(errno);
+    close(fd);
+
+    throw std::runtime_error(error);
+  }
+
+  while (true) {
+    const int client = accept(fd, nullptr, nullptr);
+
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+
+      const std::string error = std::strerror(errno);
+      close(fd);
+
+      throw std::runtime_error(error);
+    }
+
+    std::thread([this, client] {
+      serve(client, client);
+      close(client);
+    }).detach();
+  }
+}
+
+void solver_server::worker_loop() {
+  // the arena of the worker is kept between the requests, so its pools are
+  // already filled after the first ones
+  scratch_arena arena;
+  scratch_scope scope(arena);
+
+  while (true) {
+    Job job;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+
+      if (m_jobs.empty()) return;
+
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    answer(job);
+
+    std::lock_guard<std::mutex> lock(job.connection->mutex);
+
+    if (--job.connection->pending == 0) job.connection->done_cv.notify_all();
+  }
+}
+
+void solver_server::answer(const Job& job) {
+  std::string status = "ok", payload;
+  RBGraph g;
+
+  try {
+    if (job.kind == "path") {
+      read_graph(job.payload, g);
+    } else {
+      std::istringstream is(job.payload);
+      read_graph(is, g);
+    }
+
+    try {
+      const auto output =
+          reduce_matrix(g, m_options.maximal, m_options.check, false);
+
+      std::stringstream reduction;
+      for (const auto& sc : output) {
+        if (reduction.tellp() > 0) reduction << " ";
+
+        reduction << sc;
+      }
+
+      payload = reduction.str();
+    } catch (const SearchLimit& e) {
+      status = "unknown";
+      payload = e.what();
+    } catch (const std::exception& e) {
+      status = "no";
+      payload = e.what();
+    }
+  } catch (const std::exception& e) {
+    // the matrix can't be read
+    status = "error";
+    payload = e.what();
+  }
+
+  std::lock_guard<std::mutex> lock(job.connection->mutex);
+  write_all(job.connection->out, job.id + " " + status + " " +
+                                     std::to_string(payload.size()) + "\n" +
+                                     payload);
+}
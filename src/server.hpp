@@ -0,0 +1,132 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "globals.hpp"
+
+//=============================================================================
+// Resident solver (ppp --daemon)
+//
+// Requests and responses are frames made of a header line and a payload of
+// the length given in the header:
+//
+//   request:  ID KIND LENGTH\n PAYLOAD   KIND = path (PAYLOAD is a file path)
+//                                        or matrix (PAYLOAD is the contents
+//                                        of an input file)
+//   response: ID STATUS LENGTH\n PAYLOAD STATUS = ok (PAYLOAD is the
+//                                        reduction), no, unknown (search
+//                                        limit) or error (PAYLOAD is the
+//                                        reason)
+//
+// ID is chosen by the client (no spaces): the requests are reduced by a pool
+// of workers, so the responses come in the order they are completed.
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Options of the reductions of a server
+*/
+struct ServerOptions {
+  size_t workers{1};  ///< Number of worker threads
+  bool maximal{};     ///< Reduce the maximal reducible graphs
+  bool check{};       ///< Check the reductions on the matrices
+};
+
+/**
+  @brief Reduces the matrices sent over pipes or sockets with a pool of worker
+         threads, which stay up between the requests
+
+  Each worker keeps its scratch arena, and the realization cache is shared by
+  the workers and kept between the requests (see start_search), so the
+  requests after the first ones run with warm allocators and caches.
+  The matrices are reduced with the global options of the algorithm
+  (exponential, kernelization, bitmatrix, ...), but on one thread each: the
+  parallelism is across the requests.
+*/
+class solver_server {
+ public:
+  /**
+    @brief Solver server constructor, starts the workers
+
+    @param[in] options Options of the reductions
+  */
+  explicit solver_server(const ServerOptions& options);
+
+  /**
+    @brief Solver server destructor, waits for the workers to complete the
+           pending requests and terminate
+  */
+  ~solver_server();
+
+  solver_server(const solver_server&) = delete;
+  solver_server& operator=(const solver_server&) = delete;
+
+  /**
+    @brief Read the requests from \e in until the end of the input (or a
+           badly formatted request), and write their responses to \e out
+
+    Returns once every request read has been answered.
+
+    @param[in] in  File descriptor of the requests
+    @param[in] out File descriptor of the responses
+  */
+  void serve(const int in, const int out);
+
+  /**
+    @brief Accept connections on the Unix domain socket \e path, and serve
+           each one on its own thread (see serve)
+
+    A file already at \e path is replaced. Only returns by throwing
+    std::runtime_error, if the socket can't be set up.
+
+    @param[in] path Path of the socket
+  */
+  void listen(const std::string& path);
+
+ private:
+  /**
+    @brief Connection of a client, where the responses are written
+  */
+  struct Connection {
+    int out{};                          ///< File descriptor of the responses
+    std::mutex mutex{};                 ///< Guards the writes and pending
+    std::condition_variable done_cv{};  ///< Signaled when pending drops
+    size_t pending{};                   ///< Requests not answered yet
+  };
+
+  /**
+    @brief Request waiting for a worker
+  */
+  struct Job {
+    std::shared_ptr<Connection> connection;  ///< Connection of the client
+    std::string id;                          ///< Identifier of the request
+    std::string kind;                        ///< path or matrix
+    std::string payload;                     ///< Path or matrix
+  };
+
+  /**
+    @brief Main loop of each worker thread
+  */
+  void worker_loop();
+
+  /**
+    @brief Reduce the matrix of \e job and write the response
+  */
+  void answer(const Job& job);
+
+  const ServerOptions m_options;
+  std::vector<std::thread> m_workers{};
+  std::mutex m_mutex{};
+  std::condition_variable m_job_cv{};
+  std::deque<Job> m_jobs{};
+  bool m_stop{};
+};
+
+#endif  // SERVER_HPP
@@ -0,0 +1,478 @@
+#include "simd.hpp"
+#include <immintrin.h>
+
+namespace {
+
+//=============================================================================
+// Row search
+
+/**
+  @brief Check if \e row is in the relation \e R with \e s, with the tests of
+         an instruction set
+*/
+template <SetRelation R,
+          bool (*Intersects)(const uint64_t*, const uint64_t*, size_t),
+          bool (*IsSubset)(const uint64_t*, const uint64_t*, size_t)>
+__attribute__((always_inline)) inline bool related(const uint64_t* row,
+                                                   const uint64_t* s,
+                                                   const size_t n) {
+  switch (R) {
+    case SetRelation::intersects:
+      return Intersects(row, s, n);
+    case SetRelation::superset:
+      // most rows are rejected by their first word
+      return (s[0] & ~row[0]) == 0 && IsSubset(s, row, n);
+    case SetRelation::straddles:
+      return Intersects(row, s, n) && !IsSubset(row, s, n);
+    default:
+      return Intersects(row, s, n) && !IsSubset(row, s, n) &&
+             !IsSubset(s, row, n);
+  }
+}
+
+/**
+  @brief Scan of the kernel find_row for the relation \e R
+*/
+template <SetRelation R,
+          bool (*Intersects)(const uint64_t*, const uint64_t*, size_t),
+          bool (*IsSubset)(const uint64_t*, const uint64_t*, size_t)>
+__attribute__((always_inline)) inline size_t find_row(
+    const uint64_t* rows, const uint64_t* select, const size_t first,
+    const uint64_t* s, const size_t n) {
+  if (first >= 64 * n) return 64 * n;
+
+  // visit the selected rows a word of select at a time, clearing the lowest
+  // bit of the word at each row
+  auto w = first / 64;
+  auto word = select[w] & (~uint64_t(0) << (first % 64));
+
+  while (true) {
+    for (; word != 0; word &= word - 1) {
+      const auto r = 64 * w + __builtin_ctzll(word);
+
+      if (related<R, Intersects, IsSubset>(rows + r * n, s, n)) return r;
+    }
+
+    if (++w == n) return 64 * n;
+
+    word = select[w];
+  }
+}
+
+/**
+  @brief Body of the kernel find_row, inlined in the kernels of each
+         instruction set so that the tests are inlined too
+*/
+template <bool (*Intersects)(const uint64_t*, const uint64_t*, size_t),
+          bool (*IsSubset)(const uint64_t*, const uint64_t*, size_t)>
+__attribute__((always_inline)) inline size_t find_row(
+    const SetRelation rel, const uint64_t* rows, const uint64_t* select,
+    const size_t first, const uint64_t* s, const size_t n) {
+  switch (rel) {
+    case SetRelation::intersects:
+      return find_row<SetRelation::intersects, Intersects, IsSubset>(
+          rows, select, first, s, n);
+    case SetRelation::superset:
+      return find_row<SetRelation::superset, Intersects, IsSubset>(
+          rows, select, first, s, n);
+    case SetRelation::straddles:
+      return find_row<SetRelation::straddles, Intersects, IsSubset>(
+          rows, select, first, s, n);
+    default:
+      return find_row<SetRelation::crosses, Intersects, IsSubset>(
+          rows, select, first, s, n);
+  }
+}
+
+//=============================================================================
+// Scalar kernels
+
+void scalar_and(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                size_t n) {
+  for (size_t i = 0; i < n; ++i) out[i] = a[i] & b[i];
+}
+
+void scalar_andnot(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                   size_t n) {
+  for (size_t i = 0; i < n; ++i) out[i] = a[i] & ~b[i];
+}
+
+void scalar_or(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) out[i] = a[i] | b[i];
+}
+
+size_t scalar_popcount(const uint64_t* a, size_t n) {
+  size_t output = 0;
+
+  for (size_t i = 0; i < n; ++i) output += __builtin_popcountll(a[i]);
+
+  return output;
+}
+
+inline bool scalar_is_subset(const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if ((a[i] & ~b[i]) != 0) return false;
+  }
+
+  return true;
+}
+
+inline bool scalar_intersects(const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if ((a[i] & b[i]) != 0) return true;
+  }
+
+  return false;
+}
+
+bool scalar_equal(const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (a[i] != b[i]) return false;
+  }
+
+  return true;
+}
+
+size_t scalar_find_row(const SetRelation rel, const uint64_t* rows,
+                       const uint64_t* select, size_t first,
+                       const uint64_t* s, size_t n) {
+  return find_row<scalar_intersects, scalar_is_subset>(rel, rows, select, first,
+                                                       s, n);
+}
+
+//=============================================================================
+// AVX2 kernels, 4 words at a time
+
+#define AVX2_TARGET __attribute__((target("avx2,popcnt")))
+
+AVX2_TARGET inline __m256i avx2_load(const uint64_t* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2_TARGET inline void avx2_store(uint64_t* p, const __m256i v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+AVX2_TARGET void avx2_and(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                          size_t n) {
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    avx2_store(out + i, _mm256_and_si256(avx2_load(a + i), avx2_load(b + i)));
+  }
+
+  for (; i < n; ++i) out[i] = a[i] & b[i];
+}
+
+AVX2_TARGET void avx2_andnot(uint64_t* out, const uint64_t* a,
+                             const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  // _mm256_andnot_si256(x, y) = ~x & y
+  for (; i + 4 <= n; i += 4) {
+    avx2_store(out + i,
+               _mm256_andnot_si256(avx2_load(b + i), avx2_load(a + i)));
+  }
+
+  for (; i < n; ++i) out[i] = a[i] & ~b[i];
+}
+
+AVX2_TARGET void avx2_or(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                         size_t n) {
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    avx2_store(out + i, _mm256_or_si256(avx2_load(a + i), avx2_load(b + i)));
+  }
+
+  for (; i < n; ++i) out[i] = a[i] | b[i];
+}
+
+AVX2_TARGET size_t avx2_popcount(const uint64_t* a, size_t n) {
+  // AVX2 has no vector popcount, but every AVX2 CPU has the popcnt
+  // instruction, which is what __builtin_popcountll becomes in this target
+  size_t output = 0;
+
+  for (size_t i = 0; i < n; ++i) output += __builtin_popcountll(a[i]);
+
+  return output;
+}
+
+AVX2_TARGET inline bool avx2_is_subset(const uint64_t* a, const uint64_t* b,
+                                       size_t n) {
+  size_t i = 0;
+
+  // _mm256_testc_si256(x, y) is 1 if ~x & y is zero
+  for (; i + 4 <= n; i += 4) {
+    if (!_mm256_testc_si256(avx2_load(b + i), avx2_load(a + i))) return false;
+  }
+
+  for (; i < n; ++i) {
+    if ((a[i] & ~b[i]) != 0) return false;
+  }
+
+  return true;
+}
+
+AVX2_TARGET inline bool avx2_intersects(const uint64_t* a, const uint64_t* b,
+                                        size_t n) {
+  size_t i = 0;
+
+  // _mm256_testz_si256(x, y) is 1 if x & y is zero
+  for (; i + 4 <= n; i += 4) {
+    if (!_mm256_testz_si256(avx2_load(a + i), avx2_load(b + i))) return true;
+  }
+
+  for (; i < n; ++i) {
+    if ((a[i] & b[i]) != 0) return true;
+  }
+
+  return false;
+}
+
+AVX2_TARGET bool avx2_equal(const uint64_t* a, const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    const auto x = _mm256_xor_si256(avx2_load(a + i), avx2_load(b + i));
+
+    if (!_mm256_testz_si256(x, x)) return false;
+  }
+
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) return false;
+  }
+
+  return true;
+}
+
+AVX2_TARGET size_t avx2_find_row(const SetRelation rel, const uint64_t* rows,
+                                 const uint64_t* select, size_t first,
+                                 const uint64_t* s, size_t n) {
+  return find_row<avx2_intersects, avx2_is_subset>(rel, rows, select, first,
+                                                   s, n);
+}
+
+#undef AVX2_TARGET
+
+//=============================================================================
+// AVX-512 kernels, 8 words at a time and then 4 words with AVX2, so that
+// the sets of 4 words use vector operations too
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx2,popcnt")))
+
+AVX512_TARGET inline __m512i avx512_load(const uint64_t* p) {
+  return _mm512_loadu_si512(p);
+}
+
+AVX512_TARGET void avx512_and(uint64_t* out, const uint64_t* a,
+                              const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_si512(
+        out + i, _mm512_and_si512(avx512_load(a + i), avx512_load(b + i)));
+  }
+
+  if (i + 4 <= n) {
+    avx2_store(out + i, _mm256_and_si256(avx2_load(a + i), avx2_load(b + i)));
+    i += 4;
+  }
+
+  for (; i < n; ++i) out[i] = a[i] & b[i];
+}
+
+AVX512_TARGET void avx512_andnot(uint64_t* out, const uint64_t* a,
+                                 const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  // a & ~b = a ^ (a & b), which spares the warnings of _mm512_andnot_si512
+  // in GCC 12
+  for (; i + 8 <= n; i += 8) {
+    const auto x = avx512_load(a + i);
+
+    _mm512_storeu_si512(
+        out + i, _mm512_xor_si512(x, _mm512_and_si512(x, avx512_load(b + i))));
+  }
+
+  if (i + 4 <= n) {
+    avx2_store(out + i,
+               _mm256_andnot_si256(avx2_load(b + i), avx2_load(a + i)));
+    i += 4;
+  }
+
+  for (; i < n; ++i) out[i] = a[i] & ~b[i];
+}
+
+AVX512_TARGET void avx512_or(uint64_t* out, const uint64_t* a,
+                             const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_si512(
+        out + i, _mm512_or_si512(avx512_load(a + i), avx512_load(b + i)));
+  }
+
+  if (i + 4 <= n) {
+    avx2_store(out + i, _mm256_or_si256(avx2_load(a + i), avx2_load(b + i)));
+    i += 4;
+  }
+
+  for (; i < n; ++i) out[i] = a[i] | b[i];
+}
+
+AVX512_TARGET size_t avx512_popcount(const uint64_t* a, size_t n) {
+  // the vector popcount (AVX512_VPOPCNTDQ) is not part of AVX-512F
+  size_t output = 0;
+
+  for (size_t i = 0; i < n; ++i) output += __builtin_popcountll(a[i]);
+
+  return output;
+}
+
+AVX512_TARGET inline bool avx512_is_subset(const uint64_t* a,
+                                           const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  // a is a subset of b if a & b == a
+  for (; i + 8 <= n; i += 8) {
+    const auto x = avx512_load(a + i);
+
+    if (_mm512_cmpneq_epi64_mask(_mm512_and_si512(x, avx512_load(b + i)), x) !=
+        0)
+      return false;
+  }
+
+  if (i + 4 <= n) {
+    if (!_mm256_testc_si256(avx2_load(b + i), avx2_load(a + i))) return false;
+    i += 4;
+  }
+
+  for (; i < n; ++i) {
+    if ((a[i] & ~b[i]) != 0) return false;
+  }
+
+  return true;
+}
+
+AVX512_TARGET inline bool avx512_intersects(const uint64_t* a,
+                                            const uint64_t* b, size_t n) {
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    if (_mm512_test_epi64_mask(avx512_load(a + i), avx512_load(b + i)) != 0)
+      return true;
+  }
+
+  if (i + 4 <= n) {
+    if (!_mm256_testz_si256(avx2_load(a + i), avx2_load(b + i))) return true;
+    i += 4;
+  }
+
+  for (; i < n; ++i) {
+    if ((a[i] & b[i]) != 0) return true;
+  }
+
+  return false;
+}
+
+AVX512_TARGET bool avx512_equal(const uint64_t* a, const uint64_t* b,
+                                size_t n) {
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    if (_mm512_cmpneq_epi64_mask(avx512_load(a + i), avx512_load(b + i)) != 0)
+      return false;
+  }
+
+  if (i + 4 <= n) {
+    const auto x = _mm256_xor_si256(avx2_load(a + i), avx2_load(b + i));
+
+    if (!_mm256_testz_si256(x, x)) return false;
+    i += 4;
+  }
+
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) return false;
+  }
+
+  return true;
+}
+
+AVX512_TARGET size_t avx512_find_row(const SetRelation rel,
+                                     const uint64_t* rows,
+                                     const uint64_t* select, size_t first,
+                                     const uint64_t* s, size_t n) {
+  return find_row<avx512_intersects, avx512_is_subset>(rel, rows, select, first,
+                                                       s, n);
+}
+
+#undef AVX512_TARGET
+
+//=============================================================================
+// Kernel tables
+
+const SetKernels scalar_kernels{
+    SetISA::scalar,   scalar_and,        scalar_andnot,
+    scalar_or,        scalar_popcount,   scalar_is_subset,
+    scalar_intersects, scalar_equal,      scalar_find_row};
+
+const SetKernels avx2_kernels{
+    SetISA::avx2,      avx2_and,        avx2_andnot,
+    avx2_or,           avx2_popcount,   avx2_is_subset,
+    avx2_intersects,   avx2_equal,      avx2_find_row};
+
+const SetKernels avx512_kernels{
+    SetISA::avx512,    avx512_and,      avx512_andnot,
+    avx512_or,         avx512_popcount, avx512_is_subset,
+    avx512_intersects, avx512_equal,    avx512_find_row};
+
+}  // namespace
+
+//=============================================================================
+// Functions
+
+bool isa_supported(const SetISA isa) {
+  __builtin_cpu_init();
+
+  switch (isa) {
+    case SetISA::avx512:
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("popcnt");
+    case SetISA::avx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    default:
+      return true;
+  }
+}
+
+const SetKernels& set_kernels(const SetISA isa) {
+  switch (isa) {
+    case SetISA::avx512:
+      return avx512_kernels;
+    case SetISA::avx2:
+      return avx2_kernels;
+    default:
+      return scalar_kernels;
+  }
+}
+
+const SetKernels& set_kernels() {
+  static const SetKernels& output =
+      isa_supported(SetISA::avx512)
+          ? avx512_kernels
+          : isa_supported(SetISA::avx2) ? avx2_kernels : scalar_kernels;
+
+  return output;
+}
+
+std::string to_string(const SetISA isa) {
+  switch (isa) {
+    case SetISA::avx512:
+      return "avx512";
+    case SetISA::avx2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
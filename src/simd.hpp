@@ -0,0 +1,113 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//=============================================================================
+// Enums
+
+/**
+  Scoped enumeration type used for the instruction set of the set kernels.
+
+  SetISA is paired with the kernels in the struct SetKernels.
+*/
+enum class SetISA {
+  scalar,  ///< Plain 64-bit operations, runs on every CPU
+  avx2,    ///< 256-bit AVX2 operations
+  avx512   ///< 512-bit AVX-512F operations
+};
+
+/**
+  Scoped enumeration type used for the relation between a row r of a matrix
+  and a set s searched by the kernel find_row.
+*/
+enum class SetRelation {
+  intersects,  ///< r and s have an element in common
+  superset,    ///< s is a subset of r
+  straddles,   ///< r intersects s but is not a subset of s
+  crosses      ///< r intersects s, and neither one is a subset of the other
+};
+
+//=============================================================================
+// Data structures
+
+/**
+  @brief Kernels on sets stored as arrays of \e n 64-bit words, for one
+         instruction set
+
+  The arrays don't need to be aligned.
+  Each call costs an indirect jump, which is more than a test on a few words
+  takes: the sets of a matrix are better tested against a set with a single
+  call to find_row, which runs the whole scan with the instructions of the
+  kernels.
+*/
+struct SetKernels {
+  SetISA isa;  ///< Instruction set of the kernels
+
+  /// out = a & b
+  void (*and_words)(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                    size_t n);
+  /// out = a & ~b
+  void (*andnot_words)(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                       size_t n);
+  /// out = a | b
+  void (*or_words)(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                   size_t n);
+  /// Number of bits set in a
+  size_t (*popcount)(const uint64_t* a, size_t n);
+  /// Check if a & ~b is empty, that is if a is a subset of b
+  bool (*is_subset)(const uint64_t* a, const uint64_t* b, size_t n);
+  /// Check if a & b is not empty
+  bool (*intersects)(const uint64_t* a, const uint64_t* b, size_t n);
+  /// Check if a == b
+  bool (*equal)(const uint64_t* a, const uint64_t* b, size_t n);
+  /// Index of the first row r >= first of the 64 * n rows of n words in rows,
+  /// among the ones in select, that is in the relation rel with s, or 64 * n
+  /// if there is none
+  size_t (*find_row)(SetRelation rel, const uint64_t* rows,
+                     const uint64_t* select, size_t first, const uint64_t* s,
+                     size_t n);
+};
+
+//=============================================================================
+// Functions
+
+/**
+  @brief Check if the CPU supports the instruction set \e isa
+
+  @param[in] isa Instruction set
+
+  @return True if the kernels of \e isa can run on this CPU
+*/
+bool isa_supported(const SetISA isa);
+
+/**
+  @brief Return the kernels of the instruction set \e isa, which must be
+         supported (see isa_supported)
+
+  @param[in] isa Instruction set
+
+  @return Set kernels
+*/
+const SetKernels& set_kernels(const SetISA isa);
+
+/**
+  @brief Return the kernels of the widest instruction set supported by the CPU,
+         selected once at the first call
+
+  @return Set kernels
+*/
+const SetKernels& set_kernels();
+
+/**
+  @brief Return the name of the instruction set \e isa
+
+  @param[in] isa Instruction set
+
+  @return "scalar", "avx2" or "avx512"
+*/
+std::string to_string(const SetISA isa);
+
+#endif
@@ -0,0 +1,159 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+namespace stats {
+
+namespace {
+
+/**
+  Names of the phases, in the order of Phase
+*/
+const std::array<const char*, num_phases> phase_names{
+    {"parse", "maximal", "hasse", "initial_states", "chains", "realize_source",
+     "realize", "bitmatrix"}};
+
+/**
+  Names of the counters, in the order of Counter
+*/
+const std::array<const char*, num_counters> counter_names{
+    {"copy_graph", "copied_bytes", "components", "sigma_tests", "safe_sources",
+     "max_depth"}};
+
+#ifndef NO_STATS
+
+// updated by every thread (zero-initialized, as they have static storage)
+std::array<std::atomic<uint64_t>, num_phases> phase_time;
+std::array<std::atomic<uint64_t>, num_phases> phase_calls;
+std::array<std::atomic<uint64_t>, num_counters> counter_value;
+
+/**
+  Recursion depth of the calling thread
+*/
+thread_local uint64_t current_depth = 0;
+
+#endif  // NO_STATS
+
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+Report& Report::operator+=(const Report& other) {
+  instances += other.instances;
+
+  for (size_t i = 0; i < num_phases; ++i) {
+    time_ns[i] += other.time_ns[i];
+    calls[i] += other.calls[i];
+  }
+
+  for (size_t i = 0; i < num_counters; ++i) {
+    if (i == static_cast<size_t>(Counter::max_depth))
+      counters[i] = std::max(counters[i], other.counters[i]);
+    else
+      counters[i] += other.counters[i];
+  }
+
+  return *this;
+}
+
+#ifndef NO_STATS
+
+scoped_depth::scoped_depth() {
+  if (enabled) record(Counter::max_depth, ++current_depth);
+}
+
+scoped_depth::~scoped_depth() {
+  if (enabled) --current_depth;
+}
+
+//=============================================================================
+// General functions
+
+void record(const Phase phase,
+            const std::chrono::steady_clock::duration duration) {
+  const auto i = static_cast<size_t>(phase);
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+
+  phase_time[i].fetch_add(ns, std::memory_order_relaxed);
+  phase_calls[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+void record(const Counter counter, const uint64_t n) {
+  auto& value = counter_value[static_cast<size_t>(counter)];
+
+  if (counter != Counter::max_depth) {
+    value.fetch_add(n, std::memory_order_relaxed);
+
+    return;
+  }
+
+  auto current = value.load(std::memory_order_relaxed);
+  while (current < n && !value.compare_exchange_weak(
+                             current, n, std::memory_order_relaxed)) {
+  }
+}
+
+Report collect() {
+  Report output;
+  output.instances = 1;
+
+  for (size_t i = 0; i < num_phases; ++i) {
+    output.time_ns[i] = phase_time[i].load(std::memory_order_relaxed);
+    output.calls[i] = phase_calls[i].load(std::memory_order_relaxed);
+  }
+
+  for (size_t i = 0; i < num_counters; ++i) {
+    output.counters[i] = counter_value[i].load(std::memory_order_relaxed);
+  }
+
+  return output;
+}
+
+void reset() {
+  for (size_t i = 0; i < num_phases; ++i) {
+    phase_time[i].store(0, std::memory_order_relaxed);
+    phase_calls[i].store(0, std::memory_order_relaxed);
+  }
+
+  for (auto& value : counter_value) {
+    value.store(0, std::memory_order_relaxed);
+  }
+}
+
+#endif  // NO_STATS
+
+const char* phase_name(const Phase phase) {
+  return phase_names[static_cast<size_t>(phase)];
+}
+
+const char* counter_name(const Counter counter) {
+  return counter_names[static_cast<size_t>(counter)];
+}
+
+std::ostream& operator<<(std::ostream& os, const Report& report) {
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+
+  os << std::fixed << std::setprecision(3);
+
+  for (size_t i = 0; i < num_phases; ++i) {
+    os << "  " << std::left << std::setw(16) << phase_names[i] << std::right
+       << std::setw(12) << report.time_ns[i] / 1e6 << " ms"
+       << std::setw(10) << report.calls[i] << " calls" << std::endl;
+  }
+
+  for (size_t i = 0; i < num_counters; ++i) {
+    os << "  " << std::left << std::setw(16) << counter_names[i] << std::right
+       << std::setw(12) << report.counters[i] << std::endl;
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+
+  return os;
+}
+
+}  // namespace stats
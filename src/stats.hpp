@@ -0,0 +1,195 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "globals.hpp"
+
+//=============================================================================
+// Instrumentation
+//
+// Scoped timers and counters around the phases of the algorithm, reported with
+// --stats. Building with -DNO_STATS (make nostats) leaves the same interface
+// with empty inline bodies, so the instrumented code compiles to nothing.
+
+namespace stats {
+
+/**
+  @brief Timed phases of the algorithm
+*/
+enum class Phase : uint8_t {
+  parse,           ///< read_graph
+  maximal,         ///< Maximal reducible graph of each step
+  hasse,           ///< Hasse diagram of each step
+  initial_states,  ///< initial_states
+  chains,          ///< Enumeration of the chains (chain_enumerator::visit)
+  realize_source,  ///< realize_source
+  realize,         ///< realize (list of signed characters)
+  bitmatrix        ///< reduce_bitmatrix
+};
+
+/**
+  @brief Number of timed phases
+*/
+constexpr size_t num_phases = 8;
+
+/**
+  @brief Counted events of the algorithm
+*/
+enum class Counter : uint8_t {
+  copy_graph,     ///< Calls of copy_graph
+  copied_bytes,   ///< Bytes of the vertex and edge properties copied by them
+  components,     ///< Computations of the connected components of a graph
+  sigma_tests,    ///< Tests for a red Σ-graph
+  safe_sources,   ///< Safe sources found by initial_states
+  max_depth       ///< Maximum recursion depth of the reduction
+};
+
+/**
+  @brief Number of counters
+*/
+constexpr size_t num_counters = 6;
+
+/**
+  @brief Time and counters collected while reducing one or more instances
+*/
+struct Report {
+  size_t instances{};                          ///< Number of instances
+  std::array<uint64_t, num_phases> time_ns{};  ///< Time spent in each phase
+  std::array<uint64_t, num_phases> calls{};    ///< Number of calls per phase
+  std::array<uint64_t, num_counters> counters{};  ///< Value of each counter
+
+  /**
+    @brief Add the time and the counters of \e other, keep the maximum of the
+           maximum counters
+  */
+  Report& operator+=(const Report& other);
+};
+
+#ifndef NO_STATS
+
+/**
+  @brief Add \e duration to the time of \e phase, and a call
+*/
+void record(const Phase phase,
+            const std::chrono::steady_clock::duration duration);
+
+/**
+  @brief Add \e n to \e counter (or raise it to \e n for max_depth)
+*/
+void record(const Counter counter, const uint64_t n);
+
+/**
+  @brief Add \e n to \e counter if the statistics are enabled
+*/
+inline void count(const Counter counter, const uint64_t n = 1) {
+  if (enabled) record(counter, n);
+}
+
+/**
+  @brief Timer of a phase, from its construction to its destruction
+
+  With more threads the time of each thread is added up.
+*/
+class scoped_timer {
+ public:
+  /**
+    @brief Scoped timer constructor
+
+    @param[in] phase Timed phase
+  */
+  explicit scoped_timer(const Phase phase) : m_phase{phase} {
+    if (enabled) m_start = std::chrono::steady_clock::now();
+  }
+
+  /**
+    @brief Scoped timer destructor, records the elapsed time
+  */
+  ~scoped_timer() {
+    if (enabled) record(m_phase, std::chrono::steady_clock::now() - m_start);
+  }
+
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+
+ private:
+  const Phase m_phase;
+  std::chrono::steady_clock::time_point m_start{};
+};
+
+/**
+  @brief Level of recursion, from its construction to its destruction, that
+         updates the max_depth counter of the calling thread
+*/
+class scoped_depth {
+ public:
+  /**
+    @brief Scoped depth constructor, enters a level
+  */
+  scoped_depth();
+
+  /**
+    @brief Scoped depth destructor, leaves the level
+  */
+  ~scoped_depth();
+
+  scoped_depth(const scoped_depth&) = delete;
+  scoped_depth& operator=(const scoped_depth&) = delete;
+};
+
+/**
+  @brief Return the time and the counters collected since the last reset
+*/
+Report collect();
+
+/**
+  @brief Clear the time and the counters
+*/
+void reset();
+
+#else
+
+inline void count(const Counter counter, const uint64_t n = 1) {}
+
+class scoped_timer {
+ public:
+  explicit scoped_timer(const Phase phase) {}
+};
+
+class scoped_depth {
+ public:
+  scoped_depth() {}
+};
+
+inline Report collect() { return Report{}; }
+
+inline void reset() {}
+
+#endif  // NO_STATS
+
+/**
+  @brief Return the name of \e phase (as printed by operator<<)
+*/
+const char* phase_name(const Phase phase);
+
+/**
+  @brief Return the name of \e counter (as printed by operator<<)
+*/
+const char* counter_name(const Counter counter);
+
+/**
+  @brief Print \e report: the time and the calls of each phase, then the
+         counters
+
+  @param[in] os     Output stream
+  @param[in] report Report
+
+  @return Output stream
+*/
+std::ostream& operator<<(std::ostream& os, const Report& report);
+
+}  // namespace stats
+
+#endif  // STATS_HPP
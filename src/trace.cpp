@@ -0,0 +1,669 @@
+#include "trace.hpp"
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+
+namespace trace {
+
+namespace {
+
+/**
+  Formats of the events, in the order of Event
+*/
+const std::array<const char*, num_events> formats{{
+    // main
+    "F  (%n)\n",
+    "Ok (%n): < %S>\n",
+    "Ok (%n): Successful reductions have been logged\n",
+    "No (%n): %n\n",
+    "?? (%n): %n\n",
+    // reduce
+    "\nWorking on the red-black graph G\nAdjacency lists:\n%G\n\n",
+    "G empty\n\n",
+    "G not empty\nG no free characters\nG no universal characters\n",
+    "\n",
+    "\nSubgraph Gm of G induced by the maximal characters Cm\n"
+    "Adjacency lists:\n%G\n\n",
+    "Hasse diagram for the subgraph Gm\nAdjacency lists:\n%H\n\n",
+    "Search limit reached\n\n",
+    "Current safe source: [ %N( %N) ]\n\n",
+    "Realize the characters < %S> in G\n",
+    "Ok for safe source [ %N( %N) ]\n\n",
+    "No for safe source [ %N( %N) ]\n\n",
+    "Reductions: [\n",
+    "  Partial: < %S>\n",
+    "  Complete: < %S>\n",
+    "]\n\n",
+    "========================================"
+    "========================================\n\n",
+    "Source [ %N( %N) ] selected \n\n",
+    // realization
+    "Realizing %c\n",
+    "Could not realize %c\n",
+    "G free character %n\n",
+    "G universal character %n\n",
+    // red-black graphs
+    "Kernel: %u duplicate species and %u duplicate characters removed\n\n",
+    "G connected\n",
+    "Connected components: %u\n%K",
+    "Maximal characters Cm = { %N} - Count: %u\n",
+    // Hasse diagrams
+    "Hasse diagram updated, changed vertices: %u of %u\n\n",
+    "Chains of the Hasse diagram:\n\n",
+    "\nChains of the Hasse diagram terminated\n\n",
+    "Chains of source: [ %N]\n",
+    "\nEmpty chain\n\n",
+    "\nTest chain: < %S> on a copy of graph Gm\n",
+    "\nGm (copy) after the realization of the chain\nAdjacency lists:\n%G\n\n",
+    "\nTest chain: < %S> on a copy of graph Gm\n\n"
+    "Gm (copy) after the realization of the chain\nAdjacency lists:\n%G\n\n",
+    "Realization not feasible for Gm (copy)\n\n",
+    "Found red Σ-graph in Gm (copy)\n\n",
+    "No red Σ-graph in Gm (copy)\n\n",
+    "\nSource added to the list of safe sources\n\n",
+    "\nTest 2 and 3 wouldn't be feasible: the list of safe sources is not "
+    "empty\n\n",
+    "\nSource added to the list of sources\n\n",
+    // safe sources
+    "Sources: < %R>\n\n",
+    "Safe sources: < %R>\n\n",
+    "\nSafe sources - test 1\n",
+    "Source species: %n\n",
+    "Safe sources - test 1 failed\n",
+    "\nSafe sources - test 2\n",
+    "Source species (+ other maximal characters): %n\n",
+    "Safe sources - test 2 failed\n",
+    "\nSafe sources - test 3\n",
+    "Source (+ active characters): [ %N( %N) ]\n",
+    "Safe sources - test 3 failed\n",
+    "Test source realization: [ %N( %N) ] on a copy of graph G\n",
+    "\nOutcome found in the realization cache\n",
+    "\nG (copy) after the realization of the source\nAdjacency lists:\n%G\n\n",
+    "Realization not feasible for G (copy)\n",
+    "Found red Σ-graph in G (copy)\n",
+    "No red Σ-graph in G (copy)\n",
+}};
+
+// a name word is the number of a name like s12 or c3, or the length of a name
+// of any other kind, followed by its bytes (4 for each word)
+constexpr uint32_t character_bit = 1u << 31;  ///< Name starts with c
+constexpr uint32_t lose_bit = 1u << 30;       ///< Signed character, lost
+constexpr uint32_t string_bit = 1u << 29;     ///< Name of any other kind
+constexpr uint32_t value_mask = string_bit - 1;
+
+// an edge word has the index of the target and the color of the edge
+constexpr uint32_t red_bit = 1u << 31;
+
+// the first word of an event has its type and its length in words
+constexpr size_t event_bits = 8;
+constexpr size_t max_length = (size_t(1) << (32 - event_bits)) - 1;
+
+/**
+  Words of a buffer written to the trace file at once (at least)
+*/
+constexpr size_t capacity = 1 << 16;
+
+/**
+  First bytes of a trace file
+*/
+const char magic[8] = {'P', 'P', 'P', 'T', 'R', 'A', 'C', 'E'};
+
+/**
+  Version of the encoding of the events
+*/
+constexpr uint32_t version = 1;
+
+std::mutex file_mutex;
+std::FILE* file = nullptr;
+std::atomic<uint32_t> next_thread{0};
+
+/**
+  Buffer of the events of a thread, written to the trace file when it is full
+  and when the thread terminates
+*/
+struct ThreadBuffer {
+  Words words{};     ///< Events not written yet
+  uint32_t thread{};  ///< Index of the thread in the trace file
+
+  ThreadBuffer() : thread{next_thread++} { words.reserve(capacity); }
+
+  ~ThreadBuffer();
+};
+
+/**
+  @brief Write the events of \e b to the trace file (if open) as a chunk: the
+         index of the thread, the number of words and the words
+*/
+void write(ThreadBuffer& b) {
+  if (b.words.empty()) return;
+
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  if (file != nullptr) {
+    const uint32_t header[2]{b.thread, static_cast<uint32_t>(b.words.size())};
+
+    std::fwrite(header, sizeof(header), 1, file);
+    std::fwrite(b.words.data(), sizeof(uint32_t), b.words.size(), file);
+  }
+
+  b.words.clear();
+}
+
+ThreadBuffer::~ThreadBuffer() { write(*this); }
+
+thread_local ThreadBuffer local_buffer;
+
+/**
+  @brief Encode \e name, with the \e flags of a name word
+*/
+void encode_name(Words& words, const std::string& name, uint32_t flags) {
+  // compact names: s or c followed by a number without leading zeros
+  if (name.size() >= 2 && name.size() <= 10 &&
+      (name[0] == 's' || name[0] == 'c') &&
+      (name[1] != '0' || name.size() == 2)) {
+    uint64_t value = 0;
+    size_t i = 1;
+
+    for (; i < name.size() && name[i] >= '0' && name[i] <= '9'; ++i) {
+      value = 10 * value + (name[i] - '0');
+    }
+
+    if (i == name.size() && value <= value_mask) {
+      if (name[0] == 'c') flags |= character_bit;
+
+      words.push_back(flags | static_cast<uint32_t>(value));
+
+      return;
+    }
+  }
+
+  if (name.size() > value_mask)
+    throw std::length_error("Name too long for the trace");
+
+  words.push_back(flags | string_bit | static_cast<uint32_t>(name.size()));
+
+  const auto first = words.size();
+  words.resize(first + (name.size() + 3) / 4, 0);
+  std::memcpy(&words[first], name.data(), name.size());
+}
+
+template <typename Container>
+void encode_names(Words& words, const Container& names) {
+  words.push_back(static_cast<uint32_t>(names.size()));
+
+  for (const auto& name : names) {
+    encode_name(words, name, 0);
+  }
+}
+
+template <typename Container>
+void encode_signed(Words& words, const Container& lsc) {
+  words.push_back(static_cast<uint32_t>(lsc.size()));
+
+  for (const auto& sc : lsc) {
+    encode(words, sc);
+  }
+}
+
+/**
+  @brief Encode the vertices (name and type) and the edges (indexes of the
+         ends and color) of \e g
+*/
+template <typename Graph>
+void encode_graph(Words& words, const Graph& g) {
+  RBVertexIMap index(scratch());
+
+  // the number of vertices of a view is only known after visiting them
+  const auto n_vertices = words.size();
+  words.push_back(0);
+
+  const auto v_range = vertices(g);
+  for (auto v = v_range.first; v != v_range.second; ++v) {
+    index[*v] = words[n_vertices]++;
+
+    encode_name(words, g[*v].name, is_character(*v, g) ? character_bit : 0);
+  }
+
+  const auto n_edges = words.size();
+  words.push_back(0);
+
+  const auto e_range = edges(g);
+  for (auto e = e_range.first; e != e_range.second; ++e) {
+    words[n_edges]++;
+
+    words.push_back(static_cast<uint32_t>(index.at(source(*e, g))));
+    words.push_back(static_cast<uint32_t>(index.at(target(*e, g))) |
+                    (is_red(*e, g) ? red_bit : 0));
+  }
+}
+
+/**
+  Reader of the words of an event
+*/
+class word_reader {
+ public:
+  word_reader(const uint32_t* begin, const uint32_t* end)
+      : m_next{begin}, m_end{end} {}
+
+  /**
+    @brief Return the next word
+  */
+  uint32_t next() {
+    if (m_next == m_end) throw std::runtime_error("Corrupted trace file");
+
+    return *m_next++;
+  }
+
+  /**
+    @brief Return the next name, and its flags in \e flags
+  */
+  std::string name(uint32_t& flags) {
+    const auto word = next();
+    flags = word & ~value_mask;
+
+    if ((word & string_bit) == 0)
+      return ((word & character_bit) ? "c" : "s") +
+             std::to_string(word & value_mask);
+
+    const size_t length = word & value_mask;
+    const size_t n_words = (length + 3) / 4;
+
+    if (size_t(m_end - m_next) < n_words)
+      throw std::runtime_error("Corrupted trace file");
+
+    std::string output(length, '\0');
+    std::memcpy(&output[0], m_next, length);
+    m_next += n_words;
+
+    return output;
+  }
+
+  /**
+    @brief Return the next name
+  */
+  std::string name() {
+    uint32_t flags;
+
+    return name(flags);
+  }
+
+  /**
+    @brief Return the next list of names
+  */
+  std::list<std::string> names() {
+    std::list<std::string> output;
+
+    for (auto n = next(); n > 0; --n) output.push_back(name());
+
+    return output;
+  }
+
+  /**
+    @brief Return the next signed character
+  */
+  SignedCharacter signed_character() {
+    uint32_t flags;
+    const auto character = name(flags);
+
+    return {character, (flags & lose_bit) ? State::lose : State::gain};
+  }
+
+  /**
+    @brief Return the next list of signed characters
+  */
+  std::list<SignedCharacter> signed_characters() {
+    std::list<SignedCharacter> output;
+
+    for (auto n = next(); n > 0; --n) output.push_back(signed_character());
+
+    return output;
+  }
+
+  /**
+    @brief Build the next red-black graph in \e g
+  */
+  void graph(RBGraph& g) {
+    std::vector<RBVertex> vertices(next());
+
+    for (auto& v : vertices) {
+      uint32_t flags;
+      const auto v_name = name(flags);
+
+      v = add_vertex(v_name,
+                     (flags & character_bit) ? Type::character : Type::species,
+                     g);
+    }
+
+    for (auto n = next(); n > 0; --n) {
+      const auto u = next();
+      const auto word = next();
+      const auto v = word & ~red_bit;
+
+      if (u >= vertices.size() || v >= vertices.size())
+        throw std::runtime_error("Corrupted trace file");
+
+      add_edge(vertices[u], vertices[v],
+               (word & red_bit) ? Color::red : Color::black, g);
+    }
+  }
+
+  /**
+    @brief Build the next Hasse diagram in \e hasse
+  */
+  void hasse_diagram(HDGraph& hasse) {
+    for (auto n = next(); n > 0; --n) {
+      const auto species = names();
+      add_vertex(species, names(), hasse);
+    }
+
+    for (auto n = next(); n > 0; --n) {
+      const auto u = next(), v = next();
+
+      if (u >= num_vertices(hasse) || v >= num_vertices(hasse))
+        throw std::runtime_error("Corrupted trace file");
+
+      add_edge(u, v, signed_characters(), hasse);
+    }
+  }
+
+  /**
+    @brief Return true if every word has been read
+  */
+  bool done() const { return m_next == m_end; }
+
+ private:
+  const uint32_t* m_next;
+  const uint32_t* m_end;
+};
+
+/**
+  @brief Print the source with the next species and characters of \e r
+*/
+void put_source(std::ostream& os, word_reader& r) {
+  os << "[ ";
+  put(os, r.names());
+  os << "( ";
+  put(os, r.names());
+  os << ") ] ";
+}
+
+/**
+  @brief Print the event in \e r, with format \e fmt
+*/
+void render(std::ostream& os, const char* fmt, word_reader& r) {
+  for (; *fmt != '\0'; ++fmt) {
+    if (*fmt != '%') {
+      os << *fmt;
+
+      continue;
+    }
+
+    switch (*++fmt) {
+      case 'u':
+        os << r.next();
+        break;
+
+      case 'n':
+        os << r.name();
+        break;
+
+      case 'c':
+        os << r.signed_character();
+        break;
+
+      case 'N':
+        put(os, r.names());
+        break;
+
+      case 'S':
+        put(os, r.signed_characters());
+        break;
+
+      case 'R':
+        for (auto n = r.next(); n > 0; --n) put_source(os, r);
+        break;
+
+      case 'G': {
+        RBGraph g;
+        r.graph(g);
+        os << g;
+      } break;
+
+      case 'H': {
+        HDGraph hasse;
+        r.hasse_diagram(hasse);
+        os << hasse;
+      } break;
+
+      case 'K':
+        for (auto n = r.next(); n > 0; --n) {
+          RBGraph g;
+          r.graph(g);
+          os << g << std::endl << std::endl;
+        }
+        break;
+    }
+  }
+}
+
+/**
+  @brief Read \e n words from \e is into \e words, return false at the end of
+         the stream
+*/
+bool read_words(std::istream& is, uint32_t* words, const size_t n) {
+  is.read(reinterpret_cast<char*>(words), n * sizeof(uint32_t));
+
+  if (is.gcount() == 0 && is.eof()) return false;
+
+  if (size_t(is.gcount()) != n * sizeof(uint32_t))
+    throw std::runtime_error("Truncated trace file");
+
+  return true;
+}
+
+}  // namespace
+
+//=============================================================================
+// Text output
+
+void put(std::ostream& os, const Sources& sources) {
+  for (const auto& v : sources.vertices) {
+    os << "[ ";
+    put(os, sources.hasse[v].species);
+    os << "( ";
+    put(os, sources.hasse[v].characters);
+    os << ") ] ";
+  }
+}
+
+void put(std::ostream& os, const RBGraphVector& components) {
+  for (const auto& component : components) {
+    os << *component.get() << std::endl << std::endl;
+  }
+}
+
+//=============================================================================
+// Binary output
+
+void encode(Words& words, const size_t n) {
+  words.push_back(static_cast<uint32_t>(n));
+}
+
+void encode(Words& words, const std::string& s) { encode_name(words, s, 0); }
+
+void encode(Words& words, const char* s) { encode_name(words, s, 0); }
+
+void encode(Words& words, const SignedCharacter& sc) {
+  encode_name(words, sc.character, sc.state == State::lose ? lose_bit : 0);
+}
+
+void encode(Words& words, const std::list<std::string>& l) {
+  encode_names(words, l);
+}
+
+void encode(Words& words, const std::set<std::string>& l) {
+  encode_names(words, l);
+}
+
+void encode(Words& words, const std::vector<std::string>& l) {
+  encode_names(words, l);
+}
+
+void encode(Words& words, const std::list<SignedCharacter>& l) {
+  encode_signed(words, l);
+}
+
+void encode(Words& words, const std::vector<SignedCharacter>& l) {
+  encode_signed(words, l);
+}
+
+void encode(Words& words, const RBGraph& g) { encode_graph(words, g); }
+
+void encode(Words& words, const RBGraphView& g) { encode_graph(words, g); }
+
+void encode(Words& words, const HDGraph& hasse) {
+  words.push_back(static_cast<uint32_t>(num_vertices(hasse)));
+
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    encode_names(words, hasse[*v].species);
+    encode_names(words, hasse[*v].characters);
+  }
+
+  words.push_back(static_cast<uint32_t>(num_edges(hasse)));
+
+  // in the order of operator<<, so that the diagram is rebuilt the same
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    HDOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, hasse);
+    for (; e != e_end; ++e) {
+      words.push_back(static_cast<uint32_t>(*v));
+      words.push_back(static_cast<uint32_t>(target(*e, hasse)));
+      encode_signed(words, hasse[*e].signedcharacters);
+    }
+  }
+}
+
+void encode(Words& words, const Sources& sources) {
+  words.push_back(static_cast<uint32_t>(sources.vertices.size()));
+
+  for (const auto& v : sources.vertices) {
+    encode_names(words, sources.hasse[v].species);
+    encode_names(words, sources.hasse[v].characters);
+  }
+}
+
+void encode(Words& words, const RBGraphVector& components) {
+  words.push_back(static_cast<uint32_t>(components.size()));
+
+  for (const auto& component : components) {
+    encode_graph(words, *component.get());
+  }
+}
+
+Words& buffer() { return local_buffer.words; }
+
+void commit(Words& words, const size_t start) {
+  const auto length = words.size() - start - 1;
+
+  if (length > max_length) {
+    words.resize(start);
+
+    throw std::length_error("Event too large for the trace");
+  }
+
+  words[start] |= static_cast<uint32_t>(length << event_bits);
+
+  if (words.size() >= capacity) write(local_buffer);
+}
+
+//=============================================================================
+// General functions
+
+const char* format(const Event event) {
+  return formats[static_cast<size_t>(event)];
+}
+
+void open(const std::string& path) {
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  if (file != nullptr) std::fclose(file);
+
+  file = std::fopen(path.c_str(), "wb");
+
+  if (file == nullptr)
+    throw std::runtime_error("Failed to open the trace file " + path);
+
+  const uint32_t header[2]{version, static_cast<uint32_t>(num_events)};
+
+  std::fwrite(magic, sizeof(magic), 1, file);
+  std::fwrite(header, sizeof(header), 1, file);
+}
+
+void close() {
+  flush();
+
+  std::lock_guard<std::mutex> lock(file_mutex);
+
+  if (file == nullptr) return;
+
+  const bool failed = std::ferror(file) != 0;
+
+  std::fclose(file);
+  file = nullptr;
+
+  if (failed) throw std::runtime_error("Failed to write the trace file");
+}
+
+void flush() { write(local_buffer); }
+
+bool recording() { return file != nullptr; }
+
+size_t decode(std::istream& is, std::ostream& os) {
+  char file_magic[sizeof(magic)];
+  uint32_t header[2];
+
+  is.read(file_magic, sizeof(file_magic));
+
+  if (!is || std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+    throw std::runtime_error("Not a trace file");
+
+  if (!read_words(is, header, 2) || header[0] != version ||
+      header[1] != num_events)
+    throw std::runtime_error("Unsupported trace file version");
+
+  size_t output = 0;
+  Words words;
+
+  // chunks: index of the thread, number of words, words
+  uint32_t chunk[2];
+  while (read_words(is, chunk, 2)) {
+    words.resize(chunk[1]);
+
+    if (!words.empty() && !read_words(is, words.data(), words.size()))
+      throw std::runtime_error("Truncated trace file");
+
+    for (size_t i = 0; i < words.size(); ++output) {
+      const auto event = words[i] & ((1u << event_bits) - 1);
+      const size_t length = words[i] >> event_bits;
+
+      if (event >= num_events || i + 1 + length > words.size())
+        throw std::runtime_error("Corrupted trace file");
+
+      word_reader r(&words[i + 1], &words[i + 1 + length]);
+      render(os, formats[event], r);
+
+      if (!r.done()) throw std::runtime_error("Corrupted trace file");
+
+      i += 1 + length;
+    }
+  }
+
+  return output;
+}
+
+}  // namespace trace
@@ -0,0 +1,328 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+#include "globals.hpp"
+#include "hdgraph.hpp"
+
+//=============================================================================
+// Event trace
+//
+// The operations narrated with -v are typed events: each one has a format
+// (see format) whose directives are replaced by the arguments of emit. With
+// -v the events are printed on stdout as they happen; with --trace FILE they
+// are encoded in a per-thread buffer of 32-bit words (names like s12 and c3
+// take one word) which is written to FILE in chunks, and decode renders the
+// file in the same text format offline (ppp-trace).
+//
+// The algorithm only calls emit, whose inline part is a test of enabled: the
+// encoding and the printing are out of line, in a cold section. Building with
+// -DNO_TRACE (make notrace) makes enabled a false constant and emit empty, so
+// the events compile to nothing, and drops -v and --trace.
+
+namespace trace {
+
+/**
+  @brief Events of the algorithm
+*/
+enum class Event : uint8_t {
+  // main
+  file,            ///< Start of an input file
+  ok,              ///< Successful reduction of a file
+  ok_logged,       ///< Successful reductions of a file (exponential)
+  no,              ///< No successful reduction of a file
+  unknown,         ///< Search limit reached for a file
+  // reduce
+  working,         ///< Red-black graph of a reduction step
+  empty,           ///< Empty red-black graph
+  not_empty,       ///< No free or universal characters
+  newline,         ///< Empty line
+  gm,              ///< Maximal reducible graph of a step
+  hasse,           ///< Hasse diagram of a step
+  search_limit,    ///< Search limit reached (exponential)
+  current_source,  ///< Safe source being tested (exponential)
+  realize,         ///< Realization of the characters of a safe source
+  ok_source,       ///< Successful reduction of a safe source (exponential)
+  no_source,       ///< Failed reduction of a safe source (exponential)
+  reductions,      ///< Start of the list of reductions (exponential)
+  partial,         ///< Partial reduction (exponential)
+  complete,        ///< Complete reduction (exponential)
+  reductions_end,  ///< End of the list of reductions (exponential)
+  separator,       ///< Separator of the user interaction
+  selected,        ///< Safe source selected by index
+  // realization
+  realizing,       ///< Realization of a signed character
+  not_realized,    ///< Signed character that can't be realized
+  free,            ///< Free character
+  universal,       ///< Universal character
+  // red-black graphs
+  kernel,          ///< Duplicates removed by kernelize
+  connected,       ///< Connected graph
+  components,      ///< Connected components of a graph
+  maximal,         ///< Maximal characters
+  // Hasse diagrams
+  hasse_updated,   ///< Vertices changed by an incremental update
+  chains,          ///< Start of the enumeration of the chains
+  chains_end,      ///< End of the enumeration of the chains
+  chains_source,   ///< Chains of a source
+  empty_chain,     ///< Empty chain
+  test_chain,      ///< Chain tested on a copy of Gm
+  chain_realized,  ///< Copy of Gm after the realization of a chain
+  test_chain_gm,   ///< Chain tested on a copy of Gm, with the copy
+  not_feasible_gm,  ///< Realization not feasible on a copy of Gm
+  sigma_gm,         ///< Red Σ-graph in a copy of Gm
+  no_sigma_gm,      ///< No red Σ-graph in a copy of Gm
+  safe_added,       ///< Source added to the list of safe sources
+  tests_skipped,    ///< Test 2 and 3 skipped
+  source_added,     ///< Source added to the list of sources
+  // safe sources
+  sources,          ///< Sources of the Hasse diagram
+  safe_sources,     ///< Safe sources of the Hasse diagram
+  test1,            ///< Safe source test 1
+  test1_species,    ///< Species found by test 1
+  test1_failed,     ///< Safe source test 1 failed
+  test2,            ///< Safe source test 2
+  test2_species,    ///< Species found by test 2
+  test2_failed,     ///< Safe source test 2 failed
+  test3,            ///< Safe source test 3
+  test3_source,     ///< Source found by test 3
+  test3_failed,     ///< Safe source test 3 failed
+  test_source,      ///< Source realization tested on a copy of G
+  cached,           ///< Outcome of a source realization found in the cache
+  source_realized,  ///< Copy of G after the realization of a source
+  not_feasible_g,   ///< Realization not feasible on a copy of G
+  sigma_g,          ///< Red Σ-graph in a copy of G
+  no_sigma_g        ///< No red Σ-graph in a copy of G
+};
+
+/**
+  @brief Number of events
+*/
+constexpr size_t num_events = 61;
+
+/**
+  @brief List of vertices of a Hasse diagram, printed as the sources of
+         initial_states
+*/
+struct Sources {
+  const std::list<HDVertex>& vertices;  ///< Vertices
+  const HDGraph& hasse;                 ///< Hasse diagram
+};
+
+/**
+  @brief Return the format of \e event
+
+  The text is printed as is, but for the directives, each one replaced by the
+  next argument of the event: %u (number), %n (name or text), %c (signed
+  character), %N (list of names), %S (list of signed characters), %R (list of
+  sources), %G (red-black graph), %H (Hasse diagram), %K (list of red-black
+  graphs).
+
+  @param[in] event Event
+
+  @return Format of \e event
+*/
+const char* format(const Event event);
+
+/**
+  @brief Start writing the events to the file \e path (instead of stdout)
+
+  @param[in] path Path of the trace file
+*/
+void open(const std::string& path);
+
+/**
+  @brief Write the events of the calling thread left in its buffer and close
+         the trace file
+*/
+void close();
+
+/**
+  @brief Write the events of the calling thread left in its buffer to the
+         trace file, so that they come before the ones of the other threads
+*/
+void flush();
+
+/**
+  @brief Return true if the events are written to a trace file
+*/
+bool recording();
+
+/**
+  @brief Render the events of a trace file in the format printed with -v
+
+  @param[in] is Input stream of the trace file
+  @param[in] os Output stream
+
+  @return Number of events
+*/
+size_t decode(std::istream& is, std::ostream& os);
+
+//=============================================================================
+// Text output
+
+inline void put(std::ostream& os, const size_t n) { os << n; }
+
+inline void put(std::ostream& os, const std::string& s) { os << s; }
+
+inline void put(std::ostream& os, const char* s) { os << s; }
+
+inline void put(std::ostream& os, const SignedCharacter& sc) { os << sc; }
+
+template <typename Container>
+inline void put_list(std::ostream& os, const Container& list) {
+  for (const auto& i : list) {
+    os << i << " ";
+  }
+}
+
+inline void put(std::ostream& os, const std::list<std::string>& l) {
+  put_list(os, l);
+}
+
+inline void put(std::ostream& os, const std::set<std::string>& l) {
+  put_list(os, l);
+}
+
+inline void put(std::ostream& os, const std::vector<std::string>& l) {
+  put_list(os, l);
+}
+
+inline void put(std::ostream& os, const std::list<SignedCharacter>& l) {
+  put_list(os, l);
+}
+
+inline void put(std::ostream& os, const std::vector<SignedCharacter>& l) {
+  put_list(os, l);
+}
+
+inline void put(std::ostream& os, const RBGraph& g) { os << g; }
+
+inline void put(std::ostream& os, const RBGraphView& g) { os << g; }
+
+inline void put(std::ostream& os, const HDGraph& hasse) { os << hasse; }
+
+void put(std::ostream& os, const Sources& sources);
+
+void put(std::ostream& os, const RBGraphVector& components);
+
+/**
+  @brief Print \e fmt, the end of a format
+*/
+inline void print(std::ostream& os, const char* fmt) { os << fmt; }
+
+/**
+  @brief Print \e fmt with its first directive replaced by \e arg, and the
+         rest of it with \e args
+*/
+template <typename T, typename... Args>
+void print(std::ostream& os, const char* fmt, const T& arg,
+           const Args&... args) {
+  const auto directive = std::strchr(fmt, '%');
+
+  os.write(fmt, directive - fmt);
+  put(os, arg);
+  print(os, directive + 2, args...);
+}
+
+//=============================================================================
+// Binary output
+
+/**
+  Words of the events of a thread
+*/
+typedef std::vector<uint32_t> Words;
+
+void encode(Words& words, const size_t n);
+
+void encode(Words& words, const std::string& s);
+
+void encode(Words& words, const char* s);
+
+void encode(Words& words, const SignedCharacter& sc);
+
+void encode(Words& words, const std::list<std::string>& l);
+
+void encode(Words& words, const std::set<std::string>& l);
+
+void encode(Words& words, const std::vector<std::string>& l);
+
+void encode(Words& words, const std::list<SignedCharacter>& l);
+
+void encode(Words& words, const std::vector<SignedCharacter>& l);
+
+void encode(Words& words, const RBGraph& g);
+
+void encode(Words& words, const RBGraphView& g);
+
+void encode(Words& words, const HDGraph& hasse);
+
+void encode(Words& words, const Sources& sources);
+
+void encode(Words& words, const RBGraphVector& components);
+
+/**
+  @brief Return the buffer of the calling thread
+*/
+Words& buffer();
+
+/**
+  @brief Complete the event that starts at \e start in \e words, write the
+         buffer to the trace file if it is full
+*/
+void commit(Words& words, const size_t start);
+
+//=============================================================================
+// Events
+
+/**
+  @brief Emit \e event with \e args (see emit), out of line
+*/
+template <typename... Args>
+__attribute__((noinline, cold)) void emit_event(const Event event,
+                                                const Args&... args) {
+  if (!recording()) {
+    print(std::cout, format(event), args...);
+
+    return;
+  }
+
+  auto& words = buffer();
+  const auto start = words.size();
+
+  words.push_back(static_cast<uint32_t>(event));
+  (void)std::initializer_list<int>{(encode(words, args), 0)...};
+
+  commit(words, start);
+}
+
+#ifndef NO_TRACE
+
+/**
+  @brief Emit \e event with \e args (see format), if the trace is enabled
+
+  @param[in] event Event
+  @param[in] args  Arguments of the event
+*/
+template <typename... Args>
+inline void emit(const Event event, const Args&... args) {
+  if (enabled) emit_event(event, args...);
+}
+
+#else
+
+template <typename... Args>
+inline void emit(const Event, const Args&...) {}
+
+#endif  // NO_TRACE
+
+}  // namespace trace
+
+#endif  // TRACE_HPP
@@ -0,0 +1,172 @@
+#include "verifier.hpp"
+
+//=============================================================================
+// Auxiliary structs and classes
+
+reduction_checker::reduction_checker(const RBGraph& g) {
+  RBVertexIMap index(scratch());
+
+  // index the species in vertex order, the characters by name
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_species(*v, g)) {
+      index[*v] = m_species++;
+    } else {
+      index[*v] = std::stoul(g[*v].name.substr(1));
+      m_characters = std::max(m_characters, index[*v] + 1);
+    }
+  }
+
+  m_words = (m_species + 63) / 64;
+  m_black.resize(m_characters * m_words);
+  m_red.resize(m_characters * m_words);
+
+  // store the edges of each character
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (!is_character(*v, g)) continue;
+
+    const auto c = index.at(*v);
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      const auto s = index.at(target(*e, g));
+      auto& edges = is_red(*e, g) ? m_red : m_black;
+
+      edges[c * m_words + s / 64] |= uint64_t(1) << (s % 64);
+    }
+  }
+}
+
+void reduction_checker::keep_characters(
+    const std::vector<size_t>& characters) {
+  std::vector<char> keep(m_characters, false);
+
+  for (const auto c : characters) {
+    if (c < m_characters) keep[c] = true;
+  }
+
+  for (size_t c = 0; c < m_characters; ++c) {
+    if (keep[c]) continue;
+
+    std::fill_n(m_black.begin() + c * m_words, m_words, 0);
+    std::fill_n(m_red.begin() + c * m_words, m_words, 0);
+  }
+}
+
+bool reduction_checker::check(
+    const std::list<SignedCharacter>& reduction) const {
+  // replay the reduction on a copy of the matrix
+  auto black = m_black;
+  auto red = m_red;
+
+  for (const auto& sc : reduction) {
+    size_t c;
+
+    try {
+      c = std::stoul(sc.character.substr(1));
+    } catch (const std::exception& e) {
+      // not the name of a character
+      return false;
+    }
+
+    if (c >= m_characters || !realize(c, sc.state, black, red)) return false;
+  }
+
+  // the reduction is successful if no edge is left
+  for (size_t i = 0; i < black.size(); ++i) {
+    if (black[i] != 0 || red[i] != 0) return false;
+  }
+
+  return true;
+}
+
+bool reduction_checker::realize(const size_t c, const State state,
+                                std::vector<uint64_t>& black,
+                                std::vector<uint64_t>& red) const {
+  const auto n = m_words;
+  const auto c_black = &black[c * n], c_red = &red[c * n];
+
+  bool active = false;
+  for (size_t i = 0; i < n; ++i) {
+    if (c_red[i] != 0) active = true;
+  }
+
+  // species connected to c: the species adjacent to c, grown with the species
+  // of each character that shares one of them, until none is added
+  std::vector<uint64_t> conn(n);
+  for (size_t i = 0; i < n; ++i) conn[i] = c_black[i] | c_red[i];
+
+  // characters with at least an edge, not yet merged in conn
+  std::vector<size_t> pending;
+  for (size_t d = 0; d < m_characters; ++d) {
+    if (d == c) continue;
+
+    for (size_t i = 0; i < n; ++i) {
+      if ((black[d * n + i] | red[d * n + i]) != 0) {
+        pending.push_back(d);
+        break;
+      }
+    }
+  }
+
+  for (bool grown = true; grown;) {
+    grown = false;
+
+    for (size_t j = 0; j < pending.size();) {
+      const auto d_black = &black[pending[j] * n],
+                 d_red = &red[pending[j] * n];
+
+      bool shared = false;
+      for (size_t i = 0; i < n && !shared; ++i) {
+        shared = ((d_black[i] | d_red[i]) & conn[i]) != 0;
+      }
+
+      if (!shared) {
+        ++j;
+        continue;
+      }
+
+      for (size_t i = 0; i < n; ++i) conn[i] |= d_black[i] | d_red[i];
+
+      // swap the merged character with the last one
+      pending[j] = pending.back();
+      pending.pop_back();
+      grown = true;
+    }
+  }
+
+  if (state == State::gain) {
+    // c+ is feasible if c is inactive, its black edges are removed and it
+    // gets red edges to the species connected but not adjacent to it
+    if (active) return false;
+
+    for (size_t i = 0; i < n; ++i) {
+      c_red[i] = conn[i] & ~c_black[i];
+      c_black[i] = 0;
+    }
+  } else {
+    // c- is feasible if c is active and adjacent to every species connected
+    // to it, its red edges are removed
+    if (!active) return false;
+
+    for (size_t i = 0; i < n; ++i) {
+      if ((conn[i] & ~(c_black[i] | c_red[i])) != 0) return false;
+    }
+
+    std::fill_n(c_black, n, 0);
+    std::fill_n(c_red, n, 0);
+  }
+
+  return true;
+}
+
+//=============================================================================
+// General functions
+
+bool check_reduction(const RBGraph& g,
+                     const std::list<SignedCharacter>& reduction) {
+  return reduction_checker(g).check(reduction);
+}
@@ -0,0 +1,98 @@
+#ifndef VERIFIER_HPP
+#define VERIFIER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "hdgraph.hpp"
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Checker of the reductions of a red-black graph, independent of the
+         algorithm that computed them
+
+  The graph is stored as the matrix read from its file: the species of each
+  character (through black and through red edges) are sets of 64-bit words,
+  and each signed character of a reduction is replayed with a few bit
+  operations on a copy of the matrix.
+  A reduction is successful if each signed character can be realized and no
+  edge is left after the last one.
+*/
+class reduction_checker {
+ public:
+  /**
+    @brief Reduction checker constructor
+
+    The characters are indexed by the number in their names, as the ones of a
+    graph read by read_graph (c0, c1, ...).
+
+    @param[in] g Red-black graph
+  */
+  explicit reduction_checker(const RBGraph& g);
+
+  /**
+    @brief Remove the edges of the characters that are not in \e characters,
+           as the matrix reduced by the algorithm only keeps the maximal
+           characters (see maximal_reducible_graph)
+
+    @param[in] characters Indexes of the characters to keep
+  */
+  void keep_characters(const std::vector<size_t>& characters);
+
+  /**
+    @brief Check if \e reduction is a successful c-reduction of the matrix
+
+    @param[in] reduction List of signed characters
+
+    @return True if each signed character in \e reduction can be realized in
+            order, and the matrix is empty after the last one
+  */
+  bool check(const std::list<SignedCharacter>& reduction) const;
+
+  /**
+    @brief Return the number of species of the matrix
+  */
+  inline size_t num_species() const { return m_species; }
+
+  /**
+    @brief Return the number of characters of the matrix
+  */
+  inline size_t num_characters() const { return m_characters; }
+
+ private:
+  /**
+    @brief Realize the signed character (\e c, \e state) on the edges in
+           \e black and \e red, with the same rules of realize_character
+
+    @return True if the realization is feasible
+  */
+  bool realize(const size_t c, const State state, std::vector<uint64_t>& black,
+               std::vector<uint64_t>& red) const;
+
+  size_t m_species{};     ///< Number of species (rows)
+  size_t m_characters{};  ///< Number of characters (columns)
+  size_t m_words{};       ///< Number of words of each set of species
+
+  std::vector<uint64_t> m_black{};  ///< Species of each character through
+                                    ///< black edges, m_words per character
+  std::vector<uint64_t> m_red{};    ///< Species of each character through
+                                    ///< red edges, m_words per character
+};
+
+//=============================================================================
+// General functions
+
+/**
+  @brief Check if \e reduction is a successful c-reduction of \e g
+
+  @param[in] g         Red-black graph
+  @param[in] reduction List of signed characters
+
+  @return True if \e reduction is a successful c-reduction of \e g
+*/
+bool check_reduction(const RBGraph& g,
+                     const std::list<SignedCharacter>& reduction);
+
+#endif  // VERIFIER_HPP
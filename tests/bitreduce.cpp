@@ -0,0 +1,73 @@
+#include "bitmatrix.hpp"
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g;
+
+  const auto s0 = add_vertex("s0", Type::species, g);
+  const auto s1 = add_vertex("s1", Type::species, g);
+  const auto s2 = add_vertex("s2", Type::species, g);
+  const auto s3 = add_vertex("s3", Type::species, g);
+  const auto c0 = add_vertex("c0", Type::character, g);
+  const auto c1 = add_vertex("c1", Type::character, g);
+  const auto c2 = add_vertex("c2", Type::character, g);
+  const auto c3 = add_vertex("c3", Type::character, g);
+
+  add_edge(s0, c0, g);
+  add_edge(s0, c1, g);
+  add_edge(s1, c0, g);
+  add_edge(s1, c2, g);
+  add_edge(s2, c2, g);
+  add_edge(s2, c3, g);
+  add_edge(s3, c1, g);
+  add_edge(s3, c3, g);
+
+  assert(fits_bitmatrix(g));
+
+  BitMatrix<1> m(g);
+
+  assert(m.species.count() == 4);
+  assert(m.characters.count() == 4);
+  assert(m.black[0].test(0) && m.black[0].test(1));
+  assert(m.is_inactive(0));
+
+  // no free or universal characters, c0 ... c3 are maximal
+  assert(!m.is_free(0));
+  assert(!m.is_universal(0));
+  assert(m.maximal_characters().count() == 4);
+  assert(!m.has_red_sigmagraph());
+
+  // c0+ makes c0 active
+  BitReduction<1> realized;
+  assert(m.realize(0, State::gain, realized));
+  assert(realized.size == 1);
+  assert(m.is_active(0));
+  assert(m.red[0].test(2) && m.red[0].test(3));
+
+  // c1+ induces a red Σ-graph
+  assert(m.realize(1, State::gain, realized));
+  assert(m.has_red_sigmagraph());
+
+  // the reduction is the same computed on the red-black graph
+  RBGraph g_copy;
+  copy_graph(g, g_copy);
+
+  const auto bitmatrix_output = reduce_bitmatrix(g);
+  const auto output = try_reduce(g_copy);
+
+  assert(bitmatrix_output.second == (output.second == ReduceStatus::success));
+  assert(bitmatrix_output.first == output.first);
+
+  // graphs whose characters are out of order don't fit
+  RBGraph h;
+  add_vertex("s0", Type::species, h);
+  add_vertex("c1", Type::character, h);
+  add_vertex("c0", Type::character, h);
+
+  assert(!fits_bitmatrix(h));
+
+  std::cout << "bitreduce: tests passed" << std::endl;
+
+  return 0;
+}
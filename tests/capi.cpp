@@ -0,0 +1,79 @@
+#include "functions.hpp"
+#include "ppp.hpp"
+
+/**
+  @brief Return the reduction computed by ppp for the file \e filename, as
+         steps
+*/
+std::vector<ppp::Step> file_reduction(const std::string& filename) {
+  RBGraph g;
+  read_graph(filename, g);
+
+  std::vector<ppp::Step> output;
+
+  start_search();
+  for (const auto& sc : reduce(g)) {
+    output.push_back({static_cast<uint32_t>(std::stoul(sc.character.substr(1))),
+                      sc.state == State::gain});
+  }
+
+  return output;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // test_5x2.txt, with a stride of 3
+  const uint8_t ok[] = {0, 1, 9, 1, 1, 9, 1, 0, 9, 1, 1, 9, 1, 1, 9};
+  // test_6x3.txt
+  const uint8_t no[] = {0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 1, 1, 1, 0};
+
+  const auto expected = file_reduction("tests/test_5x2.txt");
+
+  // C++ interface, bit-matrix engine and red-black graphs
+  std::vector<ppp::Step> reduction;
+  ppp::Options options;
+
+  assert(ppp::solve(ok, 5, 2, 3, reduction) == ppp::Status::success);
+  assert(reduction == expected);
+
+  options.bitmatrix = false;
+  options.check = true;
+  assert(ppp::solve(ok, 5, 2, 3, reduction, options) == ppp::Status::success);
+  assert(reduction == expected);
+
+  options.exponential = true;
+  assert(ppp::solve(no, 6, 3, 3, reduction, options) ==
+         ppp::Status::no_reduction);
+  assert(reduction.empty());
+  assert(ppp::solve(no, 6, 3, 3, reduction) == ppp::Status::no_reduction);
+  assert(ppp::solve(ok, 5, 2, 1, reduction) == ppp::Status::invalid_argument);
+
+  // C interface
+  ppp_step steps[16];
+  size_t length = 0;
+
+  assert(ppp_version() == PPP_VERSION);
+  assert(ppp_solve(ok, 5, 2, 3, nullptr, steps, 16, &length) == PPP_SUCCESS);
+  assert(length == expected.size());
+
+  for (size_t i = 0; i < length; ++i) {
+    assert(steps[i].character == expected[i].character);
+    assert(steps[i].gain == expected[i].gain);
+  }
+
+  assert(ppp_solve(ok, 5, 2, 3, nullptr, steps, 1, &length) ==
+         PPP_BUFFER_TOO_SMALL);
+  assert(length == expected.size());
+
+  ppp_options c_options{};
+  c_options.kernel = 1;
+  assert(ppp_solve(no, 6, 3, 3, &c_options, steps, 16, &length) ==
+         PPP_NO_REDUCTION);
+  assert(length == 0);
+  assert(ppp_solve(nullptr, 5, 2, 3, nullptr, steps, 16, &length) ==
+         PPP_INVALID_ARGUMENT);
+
+  std::cout << "capi: tests passed" << std::endl;
+
+  return 0;
+}
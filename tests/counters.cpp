@@ -0,0 +1,49 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g;
+
+  stats::enabled = true;
+  bitmatrix::enabled = false;
+
+  read_graph("tests/test_5x2.txt", g);
+  reduce(g);
+
+  const auto report = stats::collect();
+
+#ifndef NO_STATS
+  const auto phase = [&](const stats::Phase p) {
+    return report.calls[static_cast<size_t>(p)];
+  };
+  const auto counter = [&](const stats::Counter c) {
+    return report.counters[static_cast<size_t>(c)];
+  };
+
+  assert(phase(stats::Phase::parse) == 1);
+  assert(phase(stats::Phase::hasse) >= 1);
+  assert(phase(stats::Phase::realize) >= 1);
+  assert(phase(stats::Phase::bitmatrix) == 0);
+  assert(counter(stats::Counter::safe_sources) >= 1);
+  assert(counter(stats::Counter::max_depth) >= 2);
+
+  // the totals add up, the maximum depth doesn't
+  auto total = report;
+  total += report;
+
+  assert(total.instances == 2);
+  assert(total.calls[static_cast<size_t>(stats::Phase::parse)] == 2);
+  assert(total.counters[static_cast<size_t>(stats::Counter::max_depth)] ==
+         counter(stats::Counter::max_depth));
+
+  stats::reset();
+  assert(stats::collect().calls[static_cast<size_t>(stats::Phase::parse)] ==
+         0);
+#else
+  assert(report.instances == 0);
+#endif
+
+  std::cout << "counters: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <fstream>
+#include <sstream>
+#include "functions.hpp"
+
+/**
+  @brief Emit the events of the reduction of tests/test_5x2.txt, and a few
+         names that don't fit in a word
+*/
+void run() {
+  RBGraph g;
+  read_graph("tests/test_5x2.txt", g);
+
+  start_search();
+  const auto reduction = reduce(g);
+
+  trace::emit(trace::Event::ok, "tests/test_5x2.txt", reduction);
+  trace::emit(trace::Event::free, std::string("s01"));
+  trace::emit(trace::Event::realizing,
+              SignedCharacter{"character", State::lose});
+  trace::emit(trace::Event::kernel, size_t(3), size_t(0));
+}
+
+
+int main(int argc, const char* argv[]) {
+#ifndef NO_TRACE
+  trace::enabled = true;
+  bitmatrix::enabled = false;
+
+  // events printed as they happen
+  std::ostringstream text;
+  const auto cout_buf = std::cout.rdbuf(text.rdbuf());
+  run();
+  std::cout.rdbuf(cout_buf);
+
+  assert(text.str().find("Working on the red-black graph G") !=
+         std::string::npos);
+  assert(text.str().find("G free character s01\n") != std::string::npos);
+  assert(text.str().find("Realizing character-\n") != std::string::npos);
+
+  // events written to a trace file, and decoded
+  trace::open("tests/events.bin");
+  assert(trace::recording());
+  run();
+  trace::close();
+  assert(!trace::recording());
+
+  std::ostringstream decoded;
+  {
+    std::ifstream file("tests/events.bin", std::ios::binary);
+    assert(trace::decode(file, decoded) > 10);
+  }
+
+  assert(decoded.str() == text.str());
+
+  // a truncated file is rejected
+  {
+    std::ifstream file("tests/events.bin", std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 2));
+    std::ostringstream os;
+    bool rejected = false;
+
+    try {
+      trace::decode(truncated, os);
+    } catch (const std::runtime_error& e) {
+      rejected = true;
+    }
+
+    assert(rejected);
+  }
+
+  std::remove("tests/events.bin");
+#endif
+
+  std::cout << "events: tests passed" << std::endl;
+
+  return 0;
+}
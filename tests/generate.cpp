@@ -0,0 +1,62 @@
+#include <fstream>
+#include <sstream>
+#include "functions.hpp"
+#include "generator.hpp"
+#include "verifier.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  PhylogenyParameters params;
+  params.species = 12;
+  params.characters = 10;
+  params.losses = 3;
+
+  bitmatrix::enabled = false;
+
+  for (uint64_t seed = 0; seed < 50; ++seed) {
+    std::mt19937_64 rng(seed);
+    const auto m = random_matrix(params, rng);
+
+    assert(m.species == params.species);
+    assert(m.characters == params.characters);
+    assert(m.cells.size() == m.species * m.characters);
+
+    // same graph as the one read from the printed matrix
+    RBGraph g, g_read;
+    matrix_graph(m, g);
+
+    std::ostringstream text;
+    text << m;
+    {
+      std::ofstream file("tests/generate.txt");
+      file << text.str();
+    }
+    read_graph("tests/generate.txt", g_read);
+
+    assert(num_vertices(g) == num_vertices(g_read));
+    assert(num_edges(g) == num_edges(g_read));
+
+    for (size_t i = 0; i < m.species; ++i) {
+      for (size_t j = 0; j < m.characters; ++j) {
+        const auto v = get_vertex("s" + std::to_string(i), g_read);
+        const auto u = get_vertex("c" + std::to_string(j), g_read);
+
+        assert(edge(v, u, g_read).second == bool(m.at(i, j)));
+      }
+    }
+
+    // the matrix has a persistent phylogeny
+    const auto reduction = reduce(g);
+    assert(check_reduction(g_read, reduction));
+  }
+
+  std::remove("tests/generate.txt");
+
+  // the same seed gives the same matrix
+  std::mt19937_64 rng1(7), rng2(7);
+  assert(random_matrix(params, rng1).cells == random_matrix(params, rng2).cells);
+
+  std::cout << "generate: tests passed" << std::endl;
+
+  return 0;
+}
@@ -6,7 +6,7 @@ int main(int argc, const char* argv[]) {
   RBGraph g;
 
   read_graph("tests/test_5x2.txt", g);
-  RBGraph gm = maximal_reducible_graph(g);
+  const auto gm = maximal_reducible_view(g);
   hasse_diagram(hasse, g, gm);
 
   assert(num_vertices(hasse) == 3);
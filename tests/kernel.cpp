@@ -0,0 +1,45 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g;
+
+  const auto s1 = add_vertex("s1", g);
+  const auto s2 = add_vertex("s2", g);
+  const auto s3 = add_vertex("s3", g);
+  const auto s4 = add_vertex("s4", g);
+  const auto c1 = add_vertex("c1", Type::character, g);
+  const auto c2 = add_vertex("c2", Type::character, g);
+  const auto c3 = add_vertex("c3", Type::character, g);
+
+  // s2 is a duplicate of s1, c2 is a duplicate of c1
+  add_edge(s1, c1, g);
+  add_edge(s1, c2, g);
+  add_edge(s2, c1, g);
+  add_edge(s2, c2, g);
+  add_edge(s3, c3, g);
+  add_edge(s4, c1, g);
+  add_edge(s4, c2, g);
+  add_edge(s4, c3, g);
+
+  const auto kernel = kernelize(g);
+
+  assert(num_species(g) == 3);
+  assert(num_characters(g) == 2);
+  assert(kernel.species.at("s1") == std::list<std::string>{"s2"});
+  assert(kernel.characters.at("c1") == std::list<std::string>{"c2"});
+
+  const std::list<SignedCharacter> reduction{{"c3", State::gain},
+                                             {"c1", State::gain},
+                                             {"c1", State::lose}};
+  const auto output = expand_reduction(reduction, kernel);
+
+  assert(output.size() == 5);
+  assert(std::next(output.cbegin(), 2)->character == "c2");
+  assert(std::next(output.cbegin(), 4)->character == "c2");
+  assert(std::next(output.cbegin(), 4)->state == State::lose);
+
+  std::cout << "kernel: tests passed" << std::endl;
+
+  return 0;
+}
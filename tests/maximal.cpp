@@ -50,6 +50,19 @@ int main(int argc, const char* argv[]) {
   assert(num_species(gm1) == num_species(gm2));
   assert(num_characters(gm2) == num_characters(gm1) + 1);
 
+  const auto gv1 = maximal_reducible_view(g, false);
+  const auto gv2 = maximal_reducible_view(g, true);
+
+  RBGraph gc;
+  copy_graph(gv2, gc);
+
+  assert(num_species(gv1) == num_species(gm1));
+  assert(num_characters(gv1) == num_characters(gm1));
+  assert(num_species(gv2) == num_species(gm2));
+  assert(num_characters(gv2) == num_characters(gm2));
+  assert(num_vertices(gc) == num_vertices(gm2));
+  assert(num_edges(gc) == num_edges(gm2));
+
   std::cout << "maximal: tests passed" << std::endl;
 
   return 0;
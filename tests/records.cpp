@@ -0,0 +1,102 @@
+#include <unistd.h>
+#include <thread>
+#include "output.hpp"
+
+/**
+  @brief Return the records of \e records written in \e format
+*/
+std::string write_records(const std::vector<output::Record>& records,
+                          const output::Format format, const bool stats,
+                          const size_t capacity) {
+  int fds[2];
+  const auto opened = pipe(fds) == 0;
+  assert(opened);
+
+  {
+    output::record_writer writer(fds[1], format, stats, capacity);
+
+    for (const auto& record : records) {
+      writer.write(record);
+    }
+  }
+
+  close(fds[1]);
+
+  std::string output;
+  char buffer[4096];
+  ssize_t count;
+
+  while ((count = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    output.append(buffer, count);
+  }
+
+  close(fds[0]);
+
+  return output;
+}
+
+
+int main(int argc, const char* argv[]) {
+  assert(output::parse_format("jsonl") == output::Format::jsonl);
+  assert(output::parse_format("csv") == output::Format::csv);
+
+  bool thrown = false;
+  try {
+    output::parse_format("xml");
+  } catch (const std::invalid_argument& e) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::vector<output::Record> records(3);
+  records[0].file = "ok.txt";
+  records[0].reduction = {{"c1", State::gain}, {"c0", State::gain},
+                          {"c1", State::lose}};
+  records[0].time = std::chrono::microseconds(1500);
+  records[1].file = "a,\"b\".txt";
+  records[1].status = output::Status::no;
+  records[1].reason = "Could not\treduce graph";
+  records[2].file = "limit.txt";
+  records[2].status = output::Status::unknown;
+  records[2].reason = "Search limit reached";
+
+  // a small buffer is written as it fills up, with the same output
+  const std::string jsonl =
+      "{\"file\":\"ok.txt\",\"status\":\"ok\",\"reduction\":[\"c1+\",\"c0+\","
+      "\"c1-\"],\"reason\":\"\",\"time_ms\":1.500}\n"
+      "{\"file\":\"a,\\\"b\\\".txt\",\"status\":\"no\",\"reduction\":[],"
+      "\"reason\":\"Could not\\treduce graph\",\"time_ms\":0.000}\n"
+      "{\"file\":\"limit.txt\",\"status\":\"unknown\",\"reduction\":[],"
+      "\"reason\":\"Search limit reached\",\"time_ms\":0.000}\n";
+
+  assert(write_records(records, output::Format::jsonl, false, 1 << 20) ==
+         jsonl);
+  assert(write_records(records, output::Format::jsonl, false, 16) == jsonl);
+
+  const std::string csv =
+      "file,status,reduction,reason,time_ms\n"
+      "ok.txt,ok,c1+ c0+ c1-,,1.500\n"
+      "\"a,\"\"b\"\".txt\",no,,Could not\treduce graph,0.000\n"
+      "limit.txt,unknown,,Search limit reached,0.000\n";
+
+  assert(write_records(records, output::Format::csv, false, 1 << 20) == csv);
+
+  // one column per phase and counter
+  const auto header =
+      write_records({}, output::Format::csv, true, 1 << 20);
+  assert(std::count(header.begin(), header.end(), ',') ==
+         4 + stats::num_phases + stats::num_counters);
+
+  // the progress is due first, then after the interval
+  output::progress_meter progress(8);
+  assert(progress.due());
+  assert(!progress.due());
+  assert(progress.percentage(2) == 25);
+
+  std::this_thread::sleep_for(output::progress_meter::interval);
+  assert(progress.due());
+
+  std::cout << "records: tests passed" << std::endl;
+
+  return 0;
+}
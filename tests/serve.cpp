@@ -0,0 +1,92 @@
+#include <unistd.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "functions.hpp"
+#include "server.hpp"
+
+/**
+  @brief Write \e data to the pipe \e fd
+*/
+void write_pipe(const int fd, const std::string& data) {
+  const auto count = write(fd, data.data(), data.size());
+  assert(count == static_cast<ssize_t>(data.size()));
+}
+
+/**
+  @brief Request of kind \e kind with \e payload
+*/
+std::string request(const std::string& id, const std::string& kind,
+                    const std::string& payload) {
+  return id + " " + kind + " " + std::to_string(payload.size()) + "\n" +
+         payload;
+}
+
+
+int main(int argc, const char* argv[]) {
+  std::ifstream file("tests/test_5x2.txt");
+  const std::string matrix((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+
+  int requests[2], responses[2];
+  const auto opened = pipe(requests) == 0 && pipe(responses) == 0;
+  assert(opened);
+
+  write_pipe(requests[1], request("path", "path", "tests/test_5x2.txt") +
+                              request("matrix", "matrix", matrix) +
+                              request("missing", "path", "tests/missing") +
+                              request("kind", "file", "tests/test_5x2.txt") +
+                              request("no", "path", "tests/test_6x3.txt") +
+                              "\ntruncated matrix 100\n2 2\n");
+  close(requests[1]);
+
+  {
+    ServerOptions options;
+    options.workers = 2;
+    options.check = true;
+
+    solver_server server(options);
+    server.serve(requests[0], responses[1]);
+  }
+
+  close(requests[0]);
+  close(responses[1]);
+
+  // id -> (status, payload)
+  std::map<std::string, std::pair<std::string, std::string>> output;
+  std::string data;
+  char buffer[4096];
+  ssize_t count;
+
+  while ((count = read(responses[0], buffer, sizeof(buffer))) > 0) {
+    data.append(buffer, count);
+  }
+
+  close(responses[0]);
+
+  std::istringstream is(data);
+  std::string id, status;
+  size_t length;
+
+  while (is >> id >> status >> length) {
+    std::string payload(length, ' ');
+    is.get();
+    is.read(&payload[0], length);
+
+    output[id] = std::make_pair(status, payload);
+  }
+
+  assert(output.size() == 6);
+  assert(output.at("path").first == "ok");
+  assert(output.at("path").second.find("c0+") != std::string::npos);
+  assert(output.at("matrix") == output.at("path"));
+  assert(output.at("missing").first == "error");
+  assert(output.at("kind").first == "error");
+  assert(output.at("no").first == "no");
+  // the stream can't be read past the truncated request
+  assert(output.at("truncated").first == "error");
+
+  std::cout << "serve: tests passed" << std::endl;
+
+  return 0;
+}
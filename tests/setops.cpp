@@ -0,0 +1,91 @@
+#include "simd.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+int main(int argc, const char* argv[]) {
+  const auto& scalar = set_kernels(SetISA::scalar);
+
+  std::mt19937_64 rng(0);
+
+  for (const auto isa : {SetISA::avx2, SetISA::avx512}) {
+    if (!isa_supported(isa)) continue;
+
+    const auto& kernels = set_kernels(isa);
+    assert(kernels.isa == isa);
+
+    // every length up to 3 blocks of 8 words, to cover the tails
+    for (size_t n = 0; n <= 24; ++n) {
+      std::vector<uint64_t> a(n), b(n), out(n), expected(n);
+
+      for (size_t i = 0; i < n; ++i) {
+        a[i] = rng() & rng();
+        b[i] = a[i] | rng();
+      }
+
+      // a is a subset of b
+      assert(kernels.is_subset(a.data(), b.data(), n));
+      assert(kernels.equal(a.data(), a.data(), n));
+      assert(kernels.popcount(a.data(), n) == scalar.popcount(a.data(), n));
+      assert(kernels.intersects(a.data(), b.data(), n) ==
+             scalar.intersects(a.data(), b.data(), n));
+
+      kernels.and_words(out.data(), a.data(), b.data(), n);
+      scalar.and_words(expected.data(), a.data(), b.data(), n);
+      assert(out == expected);
+
+      kernels.andnot_words(out.data(), b.data(), a.data(), n);
+      scalar.andnot_words(expected.data(), b.data(), a.data(), n);
+      assert(out == expected);
+
+      kernels.or_words(out.data(), a.data(), b.data(), n);
+      scalar.or_words(expected.data(), a.data(), b.data(), n);
+      assert(out == expected);
+
+      if (n == 0) continue;
+
+      // rows of a matrix of 64 * n sets, each tested against a
+      {
+        std::vector<uint64_t> rows(64 * n * n), select(n);
+
+        for (size_t i = 0; i < rows.size(); ++i) {
+          rows[i] = rng() & rng() & rng();
+        }
+
+        for (size_t i = 0; i < n; ++i) select[i] = rng();
+
+        // a superset of a, and a row that crosses a
+        select[0] |= 6;
+        scalar.or_words(&rows[n], a.data(), b.data(), n);
+        rows[2 * n] = a[0] ^ 3;
+
+        for (const auto rel :
+             {SetRelation::intersects, SetRelation::superset,
+              SetRelation::straddles, SetRelation::crosses}) {
+          for (size_t first = 0; first <= 64 * n; first += 3) {
+            assert(kernels.find_row(rel, rows.data(), select.data(), first,
+                                    a.data(), n) ==
+                   scalar.find_row(rel, rows.data(), select.data(), first,
+                                   a.data(), n));
+          }
+        }
+      }
+
+      // one bit of a out of b, in the last word
+      b[n - 1] &= ~(uint64_t(1) << 63);
+      a[n - 1] |= uint64_t(1) << 63;
+      assert(!kernels.is_subset(a.data(), b.data(), n));
+      assert(!kernels.equal(a.data(), b.data(), n));
+
+      // disjoint sets
+      kernels.andnot_words(b.data(), b.data(), a.data(), n);
+      assert(!kernels.intersects(a.data(), b.data(), n));
+    }
+  }
+
+  std::cout << "setops: tests passed" << std::endl;
+
+  return 0;
+}
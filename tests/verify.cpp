@@ -0,0 +1,41 @@
+#include "functions.hpp"
+#include "verifier.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g;
+
+  read_graph("tests/test_5x2.txt", g);
+
+  const reduction_checker checker(g);
+
+  assert(checker.num_species() == 5);
+  assert(checker.num_characters() == 2);
+
+  // the reduction computed by the algorithm
+  assert(checker.check(reduce(g)));
+  assert(checker.check({{"c1", State::gain},
+                        {"c0", State::gain},
+                        {"c1", State::lose}}));
+
+  // c1 is still active, c0 is inactive, c2 doesn't exist
+  assert(!checker.check({{"c1", State::gain}, {"c0", State::gain}}));
+  assert(!checker.check({{"c0", State::lose}}));
+  assert(!checker.check({{"c2", State::gain}}));
+
+  // c1- before c0 is realized: s2, s4 and s5 are connected to c1 through c0
+  assert(!checker.check({{"c1", State::gain},
+                         {"c1", State::lose},
+                         {"c0", State::gain}}));
+
+  // only c1 is kept
+  reduction_checker maximal(g);
+  maximal.keep_characters({1});
+
+  assert(maximal.check({{"c1", State::gain}}));
+  assert(!checker.check({{"c1", State::gain}}));
+
+  std::cout << "verify: tests passed" << std::endl;
+
+  return 0;
+}
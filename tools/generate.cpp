@@ -0,0 +1,195 @@
+#include <sys/stat.h>
+#include <boost/program_options.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "functions.hpp"
+#include "generator.hpp"
+
+/**
+  @brief Check if \e m has no persistent phylogeny, that is reduce finds no
+         successful c-reduction of it
+*/
+static bool unsolvable(const BinaryMatrix& m) {
+  RBGraph g;
+  matrix_graph(m, g);
+
+  try {
+    reduce(g);
+  } catch (const NoReduction& e) {
+    return true;
+  }
+
+  return false;
+}
+
+/**
+  @brief Name of the file of the \e index-th matrix of \e kind (ok or no) with
+         \e characters characters, as expected by cli-utils/log.sh
+*/
+static std::string file_name(const std::string& kind, const size_t characters,
+                             const size_t index) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%s_%02zu_%04zu_M.txt", kind.c_str(),
+                characters, index);
+
+  return name;
+}
+
+int main(int argc, const char* argv[]) {
+  PhylogenyParameters params;
+  size_t solvable, unsolvable_count, flips;
+  uint64_t seed;
+  std::string dir;
+
+  // initialize options menu
+  boost::program_options::options_description general_options(
+      "Usage: ppp-generate [OPTION...] DIR"
+      "\n"
+      "Write random matrices with a persistent phylogeny (ok_*.txt), and "
+      "perturbed matrices without one (no_*.txt), to DIR."
+      "\n\n"
+      "Options");
+
+  general_options.add_options()
+      // option: help message
+      ("help,h", "Display this message.\n")
+      // option: species, number of species of each matrix
+      ("species",
+       boost::program_options::value<size_t>(&params.species)
+           ->default_value(20),
+       "Number of species (rows).\n")
+      // option: characters, number of characters of each matrix
+      ("characters",
+       boost::program_options::value<size_t>(&params.characters)
+           ->default_value(20),
+       "Number of characters (columns).\n")
+      // option: density, depth of the trees
+      ("density",
+       boost::program_options::value<double>(&params.density)
+           ->default_value(0.5),
+       "Probability in [0, 1] that a node of the tree is a child of the "
+       "previous one: higher values give deeper trees and denser matrices.\n")
+      // option: losses, number of persistent losses
+      ("losses",
+       boost::program_options::value<size_t>(&params.losses)
+           ->default_value(0),
+       "Number of characters lost in the tree (at most).\n")
+      // option: solvable, number of matrices with a persistent phylogeny
+      ("solvable",
+       boost::program_options::value<size_t>(&solvable)->default_value(10),
+       "Number of matrices with a persistent phylogeny.\n")
+      // option: unsolvable, number of matrices without a persistent phylogeny
+      ("unsolvable",
+       boost::program_options::value<size_t>(&unsolvable_count)
+           ->default_value(0),
+       "Number of matrices without a persistent phylogeny.\n")
+      // option: flips, cells flipped in the unsolvable matrices
+      ("flips", boost::program_options::value<size_t>(&flips)->default_value(1),
+       "Number of cells flipped in a matrix with a persistent phylogeny to "
+       "get one without (until reduce rejects it).\n")
+      // option: seed, seed of the random number generator
+      ("seed", boost::program_options::value<uint64_t>(&seed)->default_value(0),
+       "Seed of the matrices: the same seed gives the same matrices.\n");
+
+  // initialize hidden options (not shown in --help)
+  boost::program_options::options_description hidden_options;
+  // option: output directory
+  hidden_options.add_options()(
+      "dir", boost::program_options::value<std::string>(&dir));
+
+  // initialize positional options
+  boost::program_options::positional_options_description positional_options;
+  positional_options.add("dir", 1);
+
+  boost::program_options::options_description cmdline_options;
+  cmdline_options.add(general_options).add(hidden_options);
+
+  boost::program_options::variables_map vm;
+
+  try {
+    boost::program_options::store(
+        boost::program_options::command_line_parser(argc, argv)
+            .positional(positional_options)
+            .options(cmdline_options)
+            .run(),
+        vm);
+
+    boost::program_options::notify(vm);
+
+    if (params.density < 0 || params.density > 1)
+      throw std::logic_error("option --density must be in [0, 1]");
+
+    if (params.species == 0 || params.characters == 0)
+      throw std::logic_error("options --species and --characters must be > 0");
+  } catch (const std::exception& e) {
+    // error while parsing the options given in input
+    std::cerr << "Error: " << e.what() << "." << std::endl
+              << "Try '" << argv[0] << " --help' for more information."
+              << std::endl;
+
+    return 1;
+  }
+
+  if (vm.count("help") || dir.empty()) {
+    std::cerr << general_options << std::endl;
+
+    return 1;
+  }
+
+  if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    std::cerr << "Error: " << dir << ": " << std::strerror(errno) << "."
+              << std::endl;
+
+    return 1;
+  }
+
+  for (size_t i = 0; i < solvable + unsolvable_count; ++i) {
+    const bool ok = i < solvable;
+    const auto index = ok ? i : i - solvable;
+
+    // each matrix has its own generator, so that it only depends on the seed
+    // and its index
+    std::seed_seq seq{uint32_t(seed), uint32_t(seed >> 32), uint32_t(ok),
+                      uint32_t(index), uint32_t(index >> 32)};
+    std::mt19937_64 rng(seq);
+
+    auto m = random_matrix(params, rng);
+
+    if (!ok) {
+      // perturb new matrices until one is rejected
+      size_t attempts = 0;
+
+      for (auto m_test = m;; m_test = random_matrix(params, rng)) {
+        perturb(m_test, flips, rng);
+
+        if (unsolvable(m_test)) {
+          m = m_test;
+
+          break;
+        }
+
+        if (++attempts == 1000) {
+          std::cerr << "Error: no unsolvable matrix found in " << attempts
+                    << " attempts, try more --flips." << std::endl;
+
+          return 1;
+        }
+      }
+    }
+
+    const auto path =
+        dir + "/" + file_name(ok ? "ok" : "no", params.characters, index);
+    std::ofstream file(path);
+    file << m;
+
+    if (!file) {
+      std::cerr << "Error: failed to write " << path << "." << std::endl;
+
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <boost/program_options.hpp>
+#include <fstream>
+#include "trace.hpp"
+
+int main(int argc, const char* argv[]) {
+  std::vector<std::string> files;
+
+  // initialize options menu
+  boost::program_options::options_description general_options(
+      "Usage: ppp-trace [OPTION...] FILE..."
+      "\n"
+      "Print the operations in the trace FILE(s) written by ppp --trace, as "
+      "ppp --verbose does."
+      "\n\n"
+      "Options");
+
+  general_options.add_options()
+      // option: help message
+      ("help,h", "Display this message.\n");
+
+  // initialize hidden options (not shown in --help)
+  boost::program_options::options_description hidden_options;
+  // option: trace files
+  hidden_options.add_options()(
+      "files", boost::program_options::value<std::vector<std::string>>(&files));
+
+  // initialize positional options
+  boost::program_options::positional_options_description positional_options;
+  positional_options.add("files", -1);
+
+  boost::program_options::options_description cmdline_options;
+  cmdline_options.add(general_options).add(hidden_options);
+
+  boost::program_options::variables_map vm;
+
+  try {
+    boost::program_options::store(
+        boost::program_options::command_line_parser(argc, argv)
+            .positional(positional_options)
+            .options(cmdline_options)
+            .run(),
+        vm);
+
+    boost::program_options::notify(vm);
+  } catch (const std::exception& e) {
+    // error while parsing the options given in input
+    std::cerr << "Error: " << e.what() << "." << std::endl
+              << "Try '" << argv[0] << " --help' for more information."
+              << std::endl;
+
+    return 1;
+  }
+
+  if (vm.count("help") || files.empty()) {
+    std::cerr << general_options << std::endl;
+
+    return 1;
+  }
+
+  for (const auto& file : files) {
+    std::ifstream is(file, std::ios::binary);
+
+    if (!is) {
+      std::cerr << "Error: " << file << ": no such file or directory."
+                << std::endl;
+
+      return 1;
+    }
+
+    try {
+      trace::decode(is, std::cout);
+    } catch (const std::exception& e) {
+      std::cout << std::flush;
+      std::cerr << "Error: " << file << ": " << e.what() << "." << std::endl;
+
+      return 1;
+    }
+  }
+
+  return 0;
+}